@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BITBOARD_HPP_
+#define BITBOARD_HPP_
+
+#include "bitops.hpp"
+
+/**
+ * a set of cells of the grid.
+ *
+ * bit idx is set, if the cell with the index idx (0..80) belongs to the set.
+ * the cells 0..63 are stored in the first word, the cells 64..80 in the
+ * second one.
+ */
+class Bitboard {
+    unsigned long long bits[2];
+public:
+    /**
+     * constructs an empty set of cells.
+     */
+    Bitboard();
+
+    /**
+     * constructs a set of cells from its two words.
+     *
+     * @param low the cells 0..63
+     * @param high the cells 64..80 in the bits 0..16
+     */
+    Bitboard(unsigned long long low, unsigned long long high);
+
+    /**
+     * returns the set of all 81 cells.
+     */
+    static Bitboard all();
+
+    /**
+     * returns true, if the cell idx belongs to the set.
+     */
+    bool test(int idx) const;
+
+    /**
+     * adds the cell idx to the set.
+     */
+    void set(int idx);
+
+    /**
+     * removes the cell idx from the set.
+     */
+    void reset(int idx);
+
+    /**
+     * adds the cell idx if it is missing and removes it otherwise.
+     */
+    void flip(int idx);
+
+    /**
+     * removes all cells from the set.
+     */
+    void clear();
+
+    /**
+     * returns the number of cells in the set.
+     */
+    int count() const;
+
+    /**
+     * returns true, if the set contains at least one cell.
+     */
+    bool any() const;
+
+    /**
+     * returns true, if the set contains exactly one cell. cheaper than
+     * count() == 1, since no population count is needed.
+     */
+    bool is_single() const;
+
+    /**
+     * returns the smallest cell index of the set or -1 if the set is empty.
+     */
+    int first() const;
+
+    /**
+     * returns the smallest cell index greater than idx or -1 if there is
+     * no such cell.
+     *
+     * \verbatim
+     for (int i = b.first(); i != -1; i = b.next(i)) \endverbatim
+     */
+    int next(int idx) const;
+
+    unsigned long long get_low() const;
+    unsigned long long get_high() const;
+
+    Bitboard &operator |=(const Bitboard &other);
+    Bitboard &operator &=(const Bitboard &other);
+    Bitboard &operator ^=(const Bitboard &other);
+
+    /**
+     * removes all cells of other from this set.
+     */
+    Bitboard &remove(const Bitboard &other);
+
+    bool operator ==(const Bitboard &other) const;
+    bool operator !=(const Bitboard &other) const;
+};
+
+Bitboard operator |(const Bitboard &a, const Bitboard &b);
+Bitboard operator &(const Bitboard &a, const Bitboard &b);
+
+inline Bitboard::Bitboard() {
+    bits[0] = 0;
+    bits[1] = 0;
+}
+
+inline Bitboard::Bitboard(unsigned long long low, unsigned long long high) {
+    bits[0] = low;
+    bits[1] = high;
+}
+
+inline Bitboard Bitboard::all() {
+    return Bitboard(~0ULL, (1ULL << 17) - 1);
+}
+
+inline bool Bitboard::test(int idx) const {
+    return (bits[idx >> 6] >> (idx & 63)) & 1;
+}
+
+inline void Bitboard::set(int idx) {
+    bits[idx >> 6] |= 1ULL << (idx & 63);
+}
+
+inline void Bitboard::reset(int idx) {
+    bits[idx >> 6] &= ~(1ULL << (idx & 63));
+}
+
+inline void Bitboard::flip(int idx) {
+    bits[idx >> 6] ^= 1ULL << (idx & 63);
+}
+
+inline void Bitboard::clear() {
+    bits[0] = 0;
+    bits[1] = 0;
+}
+
+inline int Bitboard::count() const {
+    return count_bits64(bits[0]) + count_bits64(bits[1]);
+}
+
+inline bool Bitboard::any() const {
+    return (bits[0] | bits[1]) != 0;
+}
+
+inline bool Bitboard::is_single() const {
+    if (bits[0] != 0)
+        return bits[1] == 0 && (bits[0] & (bits[0] - 1)) == 0;
+    return bits[1] != 0 && (bits[1] & (bits[1] - 1)) == 0;
+}
+
+inline int Bitboard::first() const {
+    if (bits[0] != 0)
+        return first_bit64(bits[0]);
+    if (bits[1] != 0)
+        return 64 + first_bit64(bits[1]);
+    return -1;
+}
+
+inline int Bitboard::next(int idx) const {
+    ++idx;
+    if (idx < 64) {
+        unsigned long long rest = bits[0] & (~0ULL << idx);
+        if (rest != 0)
+            return first_bit64(rest);
+        idx = 64;
+    }
+    if (idx >= 81)
+        return -1;
+    unsigned long long rest = bits[1] & (~0ULL << (idx - 64));
+    if (rest != 0)
+        return 64 + first_bit64(rest);
+    return -1;
+}
+
+inline unsigned long long Bitboard::get_low() const {
+    return bits[0];
+}
+
+inline unsigned long long Bitboard::get_high() const {
+    return bits[1];
+}
+
+inline Bitboard &Bitboard::operator |=(const Bitboard &other) {
+    bits[0] |= other.bits[0];
+    bits[1] |= other.bits[1];
+    return *this;
+}
+
+inline Bitboard &Bitboard::operator &=(const Bitboard &other) {
+    bits[0] &= other.bits[0];
+    bits[1] &= other.bits[1];
+    return *this;
+}
+
+inline Bitboard &Bitboard::operator ^=(const Bitboard &other) {
+    bits[0] ^= other.bits[0];
+    bits[1] ^= other.bits[1];
+    return *this;
+}
+
+inline Bitboard &Bitboard::remove(const Bitboard &other) {
+    bits[0] &= ~other.bits[0];
+    bits[1] &= ~other.bits[1];
+    return *this;
+}
+
+inline bool Bitboard::operator ==(const Bitboard &other) const {
+    return bits[0] == other.bits[0] && bits[1] == other.bits[1];
+}
+
+inline bool Bitboard::operator !=(const Bitboard &other) const {
+    return !(*this == other);
+}
+
+inline Bitboard operator |(const Bitboard &a, const Bitboard &b) {
+    Bitboard result(a);
+    result |= b;
+    return result;
+}
+
+inline Bitboard operator &(const Bitboard &a, const Bitboard &b) {
+    Bitboard result(a);
+    result &= b;
+    return result;
+}
+
+#endif
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bitboardsolver.hpp"
+#include "grid.hpp"
+#include "range.hpp"
+
+BitboardSolver::BitboardSolver() :
+    limit(0), max_nodes(0), has_deadline(false), nodes(0) {
+    for (int idx = 0; idx < 81; ++idx) {
+        for (RangeList::const_index_iterator i = RANGES.field_begin(idx); i
+                != RANGES.field_end(idx); ++i) {
+            peers[idx].set(*i);
+        }
+    }
+
+    for (int house = 0; house < 27; ++house) {
+        const Range &range = RANGES.get_range(house);
+        for (Range::const_iterator i = range.begin(); i != range.end(); ++i) {
+            houses[house].set(*i);
+        }
+    }
+
+    for (int idx = 0; idx < 81; ++idx) {
+        cell_houses[idx] = 0;
+        for (int i = 0; i < 3; ++i) {
+            cell_houses[idx] |= 1u << RANGES.get_field_range(idx, i).get_house();
+        }
+    }
+
+    count.count = 0;
+    count.limit_reached = false;
+    count.budget_exhausted = false;
+}
+
+BitboardSolver::~BitboardSolver() {
+}
+
+SolutionCount BitboardSolver::count_solutions(const Grid &grid, int limit,
+        long max_nodes, double max_seconds) {
+    State state;
+
+    this->limit = limit;
+    this->max_nodes = max_nodes;
+    has_deadline = max_seconds > 0;
+    if (has_deadline) {
+        deadline = std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<
+                        std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(max_seconds));
+    }
+    nodes = 0;
+    count.count = 0;
+    count.limit_reached = false;
+    count.budget_exhausted = false;
+
+    if (!init_state(grid, state))
+        return count;
+    if (has_deadline && std::chrono::steady_clock::now() >= deadline) {
+        count.budget_exhausted = true;
+        return count;
+    }
+    search(state);
+    return count;
+}
+
+SolutionCount BitboardSolver::find_first(const Grid &grid, Grid &solution,
+        long max_nodes, double max_seconds) {
+    SolutionCount result = count_solutions(grid, 1, max_nodes, max_seconds);
+    if (result.count == 0)
+        return result;
+
+    for (int idx = 0; idx < 81; ++idx) {
+        Cell &cell = solution[idx];
+        solution.set_cell_value(cell, this->solution[idx]);
+        solution.clear_choices(cell);
+    }
+    return result;
+}
+
+bool BitboardSolver::is_unique(const Grid &grid) {
+    return count_solutions(grid, 2).count == 1;
+}
+
+bool BitboardSolver::init_state(const Grid &grid, State &state) const {
+    for (int value = 0; value < 9; ++value) {
+        state.candidates[value] = Bitboard::all();
+        state.placed[value].clear();
+        state.open_houses[value] = (1u << 27) - 1;
+    }
+    state.unsolved = Bitboard::all();
+
+    for (int idx = 0; idx < 81; ++idx) {
+        const Cell &cell = grid[idx];
+        if (!cell.has_value()) {
+            const Choices &choices = cell.get_choices();
+            for (int value = 1; value < 10; ++value) {
+                if (!choices.has_choice(value))
+                    state.candidates[value - 1].reset(idx);
+            }
+        }
+    }
+
+    for (int idx = 0; idx < 81; ++idx) {
+        const Cell &cell = grid[idx];
+        if (cell.has_value() && !place(state, idx, cell.get_value() - 1))
+            return false;
+    }
+    return true;
+}
+
+bool BitboardSolver::place(State &state, int idx, int value) const {
+    if (!state.candidates[value].test(idx))
+        return false;
+
+    for (int i = 0; i < 9; ++i) {
+        state.candidates[i].reset(idx);
+    }
+    state.candidates[value].remove(peers[idx]);
+    state.placed[value].set(idx);
+    state.open_houses[value] &= ~cell_houses[idx];
+    state.unsolved.reset(idx);
+    return true;
+}
+
+bool BitboardSolver::propagate(State &state) const {
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        /*
+         * ones: cells with at least one candidate,
+         * twos: cells with at least two candidates
+         */
+        Bitboard ones;
+        Bitboard twos;
+        for (int value = 0; value < 9; ++value) {
+            twos |= ones & state.candidates[value];
+            ones |= state.candidates[value];
+        }
+
+        Bitboard dead = state.unsolved;
+        dead.remove(ones);
+        if (dead.any())
+            return false;
+
+        Bitboard singles = ones;
+        singles.remove(twos);
+        for (int idx = singles.first(); idx != -1; idx = singles.next(idx)) {
+            int value = 0;
+            while (value < 9 && !state.candidates[value].test(idx))
+                ++value;
+            /*
+             * an earlier single may have taken the last candidate
+             */
+            if (value == 9 || !place(state, idx, value))
+                return false;
+            changed = true;
+        }
+
+        /*
+         * hidden singles are only searched once there are no naked
+         * singles left, they are much more expensive to find.
+         */
+        if (changed)
+            continue;
+
+        for (int value = 0; value < 9; ++value) {
+            for (unsigned open = state.open_houses[value]; open != 0; open
+                    &= open - 1) {
+                int house = first_bit(open);
+                /*
+                 * a placement in this loop may have filled the house
+                 */
+                if (!(state.open_houses[value] & (1u << house)))
+                    continue;
+                Bitboard positions = state.candidates[value] & houses[house];
+                if (!positions.any())
+                    return false;
+                if (positions.is_single()) {
+                    place(state, positions.first(), value);
+                    changed = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int BitboardSolver::choose_cell(const State &state) const {
+    Bitboard ones;
+    Bitboard twos;
+    Bitboard threes;
+    for (int value = 0; value < 9; ++value) {
+        threes |= twos & state.candidates[value];
+        twos |= ones & state.candidates[value];
+        ones |= state.candidates[value];
+    }
+
+    /*
+     * propagate() leaves no cell with less than two candidates
+     */
+    Bitboard pairs = twos;
+    pairs.remove(threes);
+    if (pairs.any())
+        return pairs.first();
+
+    int best = -1;
+    int min = 10;
+    for (int idx = state.unsolved.first(); idx != -1; idx
+            = state.unsolved.next(idx)) {
+        int n = 0;
+        for (int value = 0; value < 9; ++value) {
+            if (state.candidates[value].test(idx))
+                ++n;
+        }
+        if (n < min) {
+            min = n;
+            best = idx;
+        }
+    }
+    return best;
+}
+
+bool BitboardSolver::search(State &state) {
+    if (!propagate(state))
+        return false;
+
+    if (!state.unsolved.any())
+        return record_solution(state);
+
+    int idx = choose_cell(state);
+    for (int value = 0; value < 9; ++value) {
+        if (!state.candidates[value].test(idx))
+            continue;
+
+        ++nodes;
+        if (is_over_budget()) {
+            count.budget_exhausted = true;
+            return true;
+        }
+
+        State next = state;
+        place(next, idx, value);
+        if (search(next))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * checks the node budget at every node and the deadline at the first and
+ * then every 16th node. a node propagates singles, so it is expensive
+ * enough to look at the clock this often.
+ */
+bool BitboardSolver::is_over_budget() {
+    if (max_nodes > 0 && nodes > max_nodes)
+        return true;
+    return has_deadline && (nodes & 15) == 1
+            && std::chrono::steady_clock::now() >= deadline;
+}
+
+bool BitboardSolver::record_solution(const State &state) {
+    if (count.count == 0) {
+        for (int value = 0; value < 9; ++value) {
+            const Bitboard &placed = state.placed[value];
+            for (int idx = placed.first(); idx != -1; idx = placed.next(idx)) {
+                solution[idx] = value + 1;
+            }
+        }
+    }
+    ++count.count;
+    if (limit > 0 && count.count >= limit) {
+        count.limit_reached = true;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BITBOARDSOLVER_HPP_
+#define BITBOARDSOLVER_HPP_
+
+#include <chrono>
+#include "solverengine.hpp"
+#include "bitboard.hpp"
+
+/**
+ * A backtracking solver working on one candidate bitboard per value.
+ *
+ * After every placement naked and hidden singles are propagated; if the
+ * grid is still open, the search branches on an unsolved cell with the
+ * fewest candidates. Every branch works on its own copy of the state
+ * (340 bytes), backtracking simply drops the copy.
+ */
+class BitboardSolver: public SolverEngine {
+private:
+    struct State {
+        /*! \brief unsolved cells where value (index + 1) is still possible */
+        Bitboard candidates[9];
+        /*! \brief cells holding the value (index + 1) */
+        Bitboard placed[9];
+        Bitboard unsolved;
+        /*! \brief houses (bit house) where value (index + 1) is not placed yet */
+        unsigned open_houses[9];
+    };
+
+    Bitboard peers[81];
+    Bitboard houses[27];
+    /*! \brief the three houses (bit house) of each cell */
+    unsigned cell_houses[81];
+
+    int limit;
+    long max_nodes;
+    bool has_deadline;
+    /*! \brief wall clock deadline of the search, like the dlx engine */
+    std::chrono::steady_clock::time_point deadline;
+    long nodes;
+    SolutionCount count;
+    unsigned char solution[81];
+public:
+    BitboardSolver();
+    virtual ~BitboardSolver();
+    SolutionCount count_solutions(const Grid &grid, int limit,
+            long max_nodes = 0, double max_seconds = 0);
+    SolutionCount find_first(const Grid &grid, Grid &solution,
+            long max_nodes = 0, double max_seconds = 0);
+    bool is_unique(const Grid &grid);
+private:
+    bool init_state(const Grid &grid, State &state) const;
+    bool place(State &state, int idx, int value) const;
+    bool propagate(State &state) const;
+    int choose_cell(const State &state) const;
+    bool search(State &state);
+    bool is_over_budget();
+    bool record_solution(const State &state);
+    BitboardSolver(const BitboardSolver &other) {
+    }
+    BitboardSolver &operator =(const BitboardSolver &other) {
+        return *this;
+    }
+};
+
+#endif /* BITBOARDSOLVER_HPP_ */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BITOPS_HPP_
+#define BITOPS_HPP_
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ * small helpers for the bit masks used to store the choices of a cell.
+ * they map to single instructions on compilers providing the builtins
+ * and fall back to portable code everywhere else.
+ */
+
+/**
+ * returns the number of bits set in x.
+ */
+inline int count_bits(unsigned int x) {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0f0f0f0fu;
+    return static_cast<int>((x * 0x01010101u) >> 24);
+#endif
+}
+
+/**
+ * returns the index of the lowest bit set in x.
+ * the result is undefined if x is zero.
+ */
+inline int first_bit(unsigned int x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, x);
+    return static_cast<int>(idx);
+#else
+    int idx = 0;
+    while ((x & 1u) == 0) {
+        x >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+/**
+ * returns the number of bits set in x.
+ */
+inline int count_bits64(unsigned long long x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    return count_bits(static_cast<unsigned int>(x))
+            + count_bits(static_cast<unsigned int>(x >> 32));
+#endif
+}
+
+/**
+ * returns the index of the lowest bit set in x.
+ * the result is undefined if x is zero.
+ */
+inline int first_bit64(unsigned long long x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    unsigned int low = static_cast<unsigned int>(x);
+    if (low != 0)
+        return first_bit(low);
+    return 32 + first_bit(static_cast<unsigned int>(x >> 32));
+#endif
+}
+
+#endif
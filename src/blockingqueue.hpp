@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BLOCKINGQUEUE_HPP_
+#define BLOCKINGQUEUE_HPP_
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * A bounded first in first out queue for passing work between threads.
+ *
+ * push() blocks while the queue is full, pop() blocks while it is empty.
+ * After close() no more items are accepted and pop() fails as soon as the
+ * queue has run empty.
+ */
+template<class T>
+class BlockingQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+public:
+    BlockingQueue(size_t capacity);
+    /*! \brief returns false if the queue has been closed */
+    bool push(const T &item);
+    /*! \brief returns false if the queue has been closed and is empty */
+    bool pop(T &item);
+    void close();
+private:
+    BlockingQueue(const BlockingQueue &other) {
+    }
+    BlockingQueue &operator =(const BlockingQueue &other) {
+        return *this;
+    }
+};
+
+template<class T>
+inline BlockingQueue<T>::BlockingQueue(size_t capacity) :
+    capacity(capacity), closed(false) {
+}
+
+template<class T>
+inline bool BlockingQueue<T>::push(const T &item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!closed && items.size() >= capacity)
+        not_full.wait(lock);
+    if (closed)
+        return false;
+    items.push_back(item);
+    not_empty.notify_one();
+    return true;
+}
+
+template<class T>
+inline bool BlockingQueue<T>::pop(T &item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!closed && items.empty())
+        not_empty.wait(lock);
+    if (items.empty())
+        return false;
+    item = items.front();
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+}
+
+template<class T>
+inline void BlockingQueue<T>::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+    not_full.notify_all();
+}
+
+#endif /* BLOCKINGQUEUE_HPP_ */
@@ -51,7 +51,7 @@ void BoxLineReductionHint::apply(Grid &grid) {
     for (std::vector<int>::const_iterator i = cells_to_clear.begin(); i
             != cells_to_clear.end(); ++i) {
         Cell &cell = grid[*i];
-        cell.remove_choice(value);
+        grid.remove_choice(cell, value);
     }
 }
 
@@ -109,7 +109,7 @@ inline std::ostream &operator <<(std::ostream &out, const print_bitset &ps) {
 }
 
 void BoxLineReductionHintProducer::find_line_hints(
-        const std::vector<Range> &ranges, int value, int start, Grid &grid,
+        const Range *ranges, int value, int start, Grid &grid,
         HintConsumer &consumer) const {
     std::vector<std::bitset<3> > positions(3); // first dimension block within range, second dimension row/col
 
@@ -191,8 +191,8 @@ void BoxLineReductionHintProducer::get_common_fields(const Range &range1,
     }
 }
 
-Hint *BoxLineReductionHintProducer::create_hint(Grid &grid, const std::vector<
-        Range> &ranges, int value, int start, int i1, int i2, int i3,
+Hint *BoxLineReductionHintProducer::create_hint(Grid &grid,
+        const Range *ranges, int value, int start, int i1, int i2, int i3,
         int rows[3]) const {
     const Range &range1 = ranges[rows[0] + start];
     const Range &range2 = ranges[rows[1] + start];
@@ -66,12 +66,12 @@ class BoxLineReductionHintProducer: public HintProducer {
 public:
     void find_hints(Grid &grid, HintConsumer &consumer);
 private:
-    void find_line_hints(const std::vector<Range> &ranges, int value,
+    void find_line_hints(const Range *ranges, int value,
             int start, Grid &grid, HintConsumer &consumer) const;
     void get_row_indexes(const std::bitset<3> &ijrows, int rows[3]) const;
     void get_common_fields(const Range &range1, const Range &range2,
             std::vector<int> &fields) const;
-    Hint *create_hint(Grid &grid, const std::vector<Range> &ranges, int value,
+    Hint *create_hint(Grid &grid, const Range *ranges, int value,
             int start, int i1, int i2, int i3, int rows[3]) const;
 };
 
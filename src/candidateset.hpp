@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANDIDATESET_HPP_
+#define CANDIDATESET_HPP_
+
+#include "bitboard.hpp"
+
+/**
+ * a set of candidates (cell, value) of the grid, stored as nine sets of
+ * cells, one for each value.
+ *
+ * eliminations of several hints can be merged with a few word operations
+ * and compared with the positions of the grid without visiting the cells.
+ */
+class CandidateSet {
+    Bitboard cells[9];
+public:
+    /**
+     * constructs an empty set of candidates.
+     */
+    CandidateSet();
+
+    /**
+     * returns true, if the candidate (idx, value) belongs to the set.
+     */
+    bool test(int idx, int value) const;
+
+    /**
+     * adds the candidate (idx, value) to the set.
+     */
+    void set(int idx, int value);
+
+    /**
+     * removes the candidate (idx, value) from the set.
+     */
+    void reset(int idx, int value);
+
+    /**
+     * removes all candidates from the set.
+     */
+    void clear();
+
+    /**
+     * returns the number of candidates in the set.
+     */
+    int count() const;
+
+    /**
+     * returns true, if the set contains at least one candidate.
+     */
+    bool any() const;
+
+    /**
+     * returns the cells, which have the candidate value in the set.
+     */
+    const Bitboard &get_cells(int value) const;
+
+    /**
+     * returns the cells, which have at least one candidate in the set.
+     */
+    Bitboard get_cells() const;
+
+    /**
+     * returns the values (bit value - 1) of the candidates of cell idx.
+     */
+    unsigned int get_values(int idx) const;
+
+    CandidateSet &operator |=(const CandidateSet &other);
+    CandidateSet &operator &=(const CandidateSet &other);
+
+    /**
+     * removes all candidates of other from this set.
+     */
+    CandidateSet &remove(const CandidateSet &other);
+
+    /**
+     * returns true, if both sets have at least one candidate in common.
+     */
+    bool intersects(const CandidateSet &other) const;
+
+    bool operator ==(const CandidateSet &other) const;
+    bool operator !=(const CandidateSet &other) const;
+};
+
+inline CandidateSet::CandidateSet() {
+}
+
+inline bool CandidateSet::test(int idx, int value) const {
+    return cells[value - 1].test(idx);
+}
+
+inline void CandidateSet::set(int idx, int value) {
+    cells[value - 1].set(idx);
+}
+
+inline void CandidateSet::reset(int idx, int value) {
+    cells[value - 1].reset(idx);
+}
+
+inline void CandidateSet::clear() {
+    for (int i = 0; i < 9; ++i)
+        cells[i].clear();
+}
+
+inline int CandidateSet::count() const {
+    int result = 0;
+    for (int i = 0; i < 9; ++i)
+        result += cells[i].count();
+    return result;
+}
+
+inline bool CandidateSet::any() const {
+    return get_cells().any();
+}
+
+inline const Bitboard &CandidateSet::get_cells(int value) const {
+    return cells[value - 1];
+}
+
+inline Bitboard CandidateSet::get_cells() const {
+    Bitboard result;
+    for (int i = 0; i < 9; ++i)
+        result |= cells[i];
+    return result;
+}
+
+inline unsigned int CandidateSet::get_values(int idx) const {
+    unsigned int result = 0;
+    for (int i = 0; i < 9; ++i)
+        result |= static_cast<unsigned int> (cells[i].test(idx)) << i;
+    return result;
+}
+
+inline CandidateSet &CandidateSet::operator |=(const CandidateSet &other) {
+    for (int i = 0; i < 9; ++i)
+        cells[i] |= other.cells[i];
+    return *this;
+}
+
+inline CandidateSet &CandidateSet::operator &=(const CandidateSet &other) {
+    for (int i = 0; i < 9; ++i)
+        cells[i] &= other.cells[i];
+    return *this;
+}
+
+inline CandidateSet &CandidateSet::remove(const CandidateSet &other) {
+    for (int i = 0; i < 9; ++i)
+        cells[i].remove(other.cells[i]);
+    return *this;
+}
+
+inline bool CandidateSet::intersects(const CandidateSet &other) const {
+    Bitboard common;
+    for (int i = 0; i < 9; ++i)
+        common |= cells[i] & other.cells[i];
+    return common.any();
+}
+
+inline bool CandidateSet::operator ==(const CandidateSet &other) const {
+    for (int i = 0; i < 9; ++i) {
+        if (cells[i] != other.cells[i])
+            return false;
+    }
+    return true;
+}
+
+inline bool CandidateSet::operator !=(const CandidateSet &other) const {
+    return !(*this == other);
+}
+
+#endif /* CANDIDATESET_HPP_ */
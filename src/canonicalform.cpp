@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include "canonicalform.hpp"
+#include "grid.hpp"
+
+namespace {
+
+const int PERMUTATIONS[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1,
+        2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+/*
+ * the smallest pattern of a stack with 0..3 givens: the givens are moved
+ * to the right.
+ */
+const unsigned RIGHT_ALIGNED[4] = { 0, 1, 3, 7 };
+
+/*
+ * returns true if an empty line of lines is moved behind another empty line
+ * of the same block or an empty block is moved behind another empty block.
+ * empty is the mask of the empty source lines, order the source line of
+ * each target line.
+ */
+/*
+ * places stack source_stack, permuted by PERMUTATIONS[permutation], at
+ * stack position stack of cols.
+ */
+void set_stack(unsigned char *cols, int stack, int source_stack,
+        int permutation) {
+    const int *p = PERMUTATIONS[permutation];
+    for (int j = 0; j < 3; ++j) {
+        cols[3 * stack + j] = 3 * source_stack + p[j];
+    }
+}
+
+bool is_redundant_order(unsigned empty, const int *order, int size) {
+    for (int i = 0; i < size; ++i)
+        for (int j = i + 1; j < size; ++j)
+            if ((empty >> order[i]) & (empty >> order[j]) & 1 && order[i]
+                    > order[j])
+                return true;
+    return false;
+}
+
+}
+
+Transformation::Transformation() :
+    transposed(false) {
+    for (int i = 0; i < 9; ++i) {
+        rows[i] = i;
+        cols[i] = i;
+    }
+    for (int d = 0; d < 10; ++d)
+        digits[d] = d;
+    init_inverse();
+}
+
+Transformation::Transformation(bool transposed, const int *rows,
+        const int *cols, const int *digits) :
+    transposed(transposed) {
+    for (int i = 0; i < 9; ++i) {
+        this->rows[i] = rows[i];
+        this->cols[i] = cols[i];
+    }
+    this->digits[0] = 0;
+    for (int d = 1; d < 10; ++d)
+        this->digits[d] = digits[d];
+    init_inverse();
+}
+
+void Transformation::init_inverse() {
+    for (int i = 0; i < 9; ++i) {
+        inverse_rows[rows[i]] = i;
+        inverse_cols[cols[i]] = i;
+    }
+    for (int d = 0; d < 10; ++d)
+        inverse_digits[digits[d]] = d;
+}
+
+int Transformation::map_cell(int idx) const {
+    int row = idx / 9;
+    int col = idx % 9;
+    if (transposed)
+        return inverse_rows[col] * 9 + inverse_cols[row];
+    return inverse_rows[row] * 9 + inverse_cols[col];
+}
+
+int Transformation::unmap_cell(int idx) const {
+    int row = rows[idx / 9];
+    int col = cols[idx % 9];
+    return transposed ? col * 9 + row : row * 9 + col;
+}
+
+void Transformation::apply(const Grid &from, Grid &to) const {
+    char text[81];
+    for (int i = 0; i < 81; ++i) {
+        int v = from[unmap_cell(i)].get_value();
+        text[i] = v ? '0' + digits[v] : '.';
+    }
+    to.load(text, text + 81);
+}
+
+void Transformation::revert(const Grid &from, Grid &to) const {
+    char text[81];
+    for (int i = 0; i < 81; ++i) {
+        int v = from[i].get_value();
+        text[unmap_cell(i)] = v ? '0' + inverse_digits[v] : '.';
+    }
+    to.load(text, text + 81);
+}
+
+Canonicalizer::Canonicalizer() {
+}
+
+void Canonicalizer::canonicalize(const Grid &grid, unsigned char *canonical,
+        Transformation &transformation) {
+    for (int i = 0; i < 81; ++i) {
+        values[0][i] = grid[i].get_value();
+        values[1][(i % 9) * 9 + i / 9] = values[0][i];
+    }
+    empty_rows[0] = empty_rows[1] = 0x1ff;
+    for (int i = 0; i < 81; ++i) {
+        if (values[0][i]) {
+            empty_rows[0] &= ~(1u << (i / 9));
+            empty_rows[1] &= ~(1u << (i % 9));
+        }
+    }
+
+    find_first_rows();
+    for (int row = 1; row < 9; ++row) {
+        find_row(row);
+    }
+
+    /*
+     * all remaining candidates produce the same grid. digits which are
+     * not given are numbered after the given ones.
+     */
+    const Candidate &c = current.front();
+    int next_digit = c.next_digit;
+    transformation.transposed = c.transposed;
+    transformation.digits[0] = 0;
+    for (int i = 0; i < 9; ++i) {
+        transformation.rows[i] = c.rows[i];
+        transformation.cols[i] = c.cols[i];
+    }
+    for (int d = 1; d < 10; ++d) {
+        transformation.digits[d] = c.digits[d] ? c.digits[d] : next_digit++;
+    }
+    transformation.init_inverse();
+
+    for (int i = 0; i < 81; ++i) {
+        int v = values[0][transformation.unmap_cell(i)];
+        canonical[i] = transformation.digits[v];
+    }
+}
+
+void Canonicalizer::canonicalize(const Grid &grid, Grid &canonical,
+        Transformation &transformation) {
+    unsigned char digits[81];
+    char text[81];
+
+    canonicalize(grid, digits, transformation);
+    for (int i = 0; i < 81; ++i) {
+        text[i] = digits[i] ? '0' + digits[i] : '.';
+    }
+    canonical.load(text, text + 81);
+}
+
+/**
+ * finds the candidates for the first row. the relabeled first row always
+ * reads 1, 2, 3, ... from left to right, so only the pattern of the givens
+ * matters: empty cells have to come first. the minimal pattern of a row
+ * puts the stacks in ascending order of their number of givens and the
+ * givens of each stack to the right, so only the column permutations
+ * doing so are generated. empty columns and stacks keep their order.
+ *
+ * the second row comes from the band of the first one. zero is the
+ * smallest digit, so a candidate whose second row starts with fewer empty
+ * cells than the best one can never win, whatever the digits are. these
+ * candidates are dropped before their digits are relabeled.
+ */
+void Canonicalizer::find_first_rows() {
+    unsigned best = ~0u;
+    int counts[2][9][3];
+    unsigned masks[2][9];
+
+    for (int t = 0; t < 2; ++t) {
+        for (int r = 0; r < 9; ++r) {
+            int *n = counts[t][r];
+            for (int s = 0; s < 3; ++s) {
+                n[s] = (values[t][9 * r + 3 * s] != 0) + (values[t][9 * r
+                        + 3 * s + 1] != 0) + (values[t][9 * r + 3 * s + 2]
+                        != 0);
+            }
+            int lo = std::min(n[0], std::min(n[1], n[2]));
+            int hi = std::max(n[0], std::max(n[1], n[2]));
+            int mid = n[0] + n[1] + n[2] - lo - hi;
+            unsigned mask = (RIGHT_ALIGNED[lo] << 6) | (RIGHT_ALIGNED[mid]
+                    << 3) | RIGHT_ALIGNED[hi];
+            if (mask < best)
+                best = mask;
+            masks[t][r] = mask;
+        }
+    }
+
+    int best_lead = 0;
+    current.clear();
+    for (int t = 0; t < 2; ++t) {
+        /*
+         * the columns of values[t] are the rows of the other orientation.
+         */
+        unsigned empty_cols = empty_rows[1 - t];
+        unsigned empty_stacks = 0;
+        for (int s = 0; s < 3; ++s) {
+            if (((empty_cols >> (3 * s)) & 7) == 7)
+                empty_stacks |= 1 << s;
+        }
+
+        for (int r = 0; r < 9; ++r) {
+            if (masks[t][r] != best || is_redundant_row(t, r, 0))
+                continue;
+            const unsigned char *row = values[t] + 9 * r;
+            const int *n = counts[t][r];
+
+            /*
+             * the within stack permutations keeping the givens to the right
+             */
+            int within[3][6];
+            int num_within[3];
+            for (int s = 0; s < 3; ++s) {
+                num_within[s] = 0;
+                for (int p = 0; p < 6; ++p) {
+                    const int *q = PERMUTATIONS[p];
+                    bool b0 = row[3 * s + q[0]] != 0;
+                    bool b1 = row[3 * s + q[1]] != 0;
+                    bool b2 = row[3 * s + q[2]] != 0;
+                    if (b0 <= b1 && b1 <= b2 && !is_redundant_order(
+                            empty_cols >> (3 * s), q, 3))
+                        within[s][num_within[s]++] = p;
+                }
+            }
+
+            for (int o = 0; o < 6; ++o) {
+                const int *order = PERMUTATIONS[o];
+                if (n[order[0]] > n[order[1]] || n[order[1]] > n[order[2]]
+                        || is_redundant_order(empty_stacks, order, 3))
+                    continue;
+                /*
+                 * the columns are fixed stack by stack. as soon as the
+                 * leading empty cells end within the fixed columns, the
+                 * remaining stacks cannot change their number any more.
+                 */
+                Candidate c;
+                for (int a = 0; a < num_within[order[0]]; ++a) {
+                    set_stack(c.cols, 0, order[0], within[order[0]][a]);
+                    if (count_leading_empty(t, r, c.cols, 3) < std::min(3,
+                            best_lead))
+                        continue;
+                    for (int b = 0; b < num_within[order[1]]; ++b) {
+                        set_stack(c.cols, 1, order[1], within[order[1]][b]);
+                        if (count_leading_empty(t, r, c.cols, 6) < std::min(6,
+                                best_lead))
+                            continue;
+                        for (int d = 0; d < num_within[order[2]]; ++d) {
+                            set_stack(c.cols, 2, order[2], within[order[2]][d]);
+                            int lead = count_leading_empty(t, r, c.cols, 9);
+                            if (lead < best_lead)
+                                continue;
+                            if (lead > best_lead) {
+                                best_lead = lead;
+                                current.clear();
+                            }
+
+                            c.transposed = t != 0;
+                            c.rows[0] = r;
+                            c.used_rows = 1 << r;
+                            memset(c.digits, 0, sizeof(c.digits));
+                            c.next_digit = 1;
+                            for (int j = 0; j < 9; ++j) {
+                                int v = row[c.cols[j]];
+                                if (v && !c.digits[v])
+                                    c.digits[v] = c.next_digit++;
+                            }
+                            current.push_back(c);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * extends the candidates by one row and keeps those producing the minimal
+ * row. the first row of a band can be taken from any unused band, the
+ * other rows from the band already started. empty rows and bands keep
+ * their order.
+ */
+void Canonicalizer::find_row(int row) {
+    unsigned char best[9];
+    bool found = false;
+
+    next.clear();
+    for (std::vector<Candidate>::const_iterator c = current.begin(); c
+            != current.end(); ++c) {
+        const unsigned char *grid = values[c->transposed ? 1 : 0];
+        int first;
+        int last;
+        if (row % 3 == 0) {
+            first = 0;
+            last = 9;
+        } else {
+            first = c->rows[row - row % 3] / 3 * 3;
+            last = first + 3;
+        }
+
+        for (int r = first; r < last; ++r) {
+            if (c->used_rows & (1 << r))
+                continue;
+            if (row % 3 == 0 && (c->used_rows >> (r / 3 * 3)) & 7)
+                continue;
+            if (is_redundant_row(c->transposed ? 1 : 0, r, c->used_rows))
+                continue;
+
+            unsigned char digits[10];
+            unsigned char line[9];
+            int next_digit = c->next_digit;
+            int order = found ? 0 : -1;
+            memcpy(digits, c->digits, sizeof(digits));
+            for (int j = 0; j < 9; ++j) {
+                int v = grid[9 * r + c->cols[j]];
+                if (v && !digits[v])
+                    digits[v] = next_digit++;
+                line[j] = digits[v];
+                if (order == 0 && line[j] != best[j]) {
+                    order = line[j] < best[j] ? -1 : 1;
+                    if (order > 0)
+                        break;
+                }
+            }
+            if (order > 0)
+                continue;
+            if (order < 0) {
+                memcpy(best, line, 9);
+                found = true;
+                next.clear();
+            }
+
+            Candidate n = *c;
+            n.rows[row] = r;
+            n.used_rows |= 1 << r;
+            memcpy(n.digits, digits, sizeof(digits));
+            n.next_digit = next_digit;
+            next.push_back(n);
+        }
+    }
+    current.swap(next);
+}
+
+/**
+ * returns true if row r of values[t] is empty and an unused empty row of
+ * the same band comes before it, or if its band is empty and an unused
+ * empty band comes before it. taking the earlier row or band yields the
+ * same grid.
+ */
+bool Canonicalizer::is_redundant_row(int t, int r, unsigned used_rows) const {
+    unsigned empty = empty_rows[t] & ~used_rows;
+    if (!(empty & (1 << r)))
+        return false;
+    int band = r / 3 * 3;
+    if (empty & ~(~0u << r) & (7u << band))
+        return true;
+    if (((empty >> band) & 7) != 7)
+        return false;
+    for (int b = 0; b < band; b += 3) {
+        if (((empty >> b) & 7) == 7)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * returns the largest number of leading empty cells the other rows of the
+ * band of row r of values[t] have within the first size columns, taken in
+ * the order cols.
+ */
+int Canonicalizer::count_leading_empty(int t, int r,
+        const unsigned char *cols, int size) const {
+    int best = 0;
+    int band = r / 3 * 3;
+    for (int other = band; other < band + 3; ++other) {
+        if (other == r)
+            continue;
+        const unsigned char *row = values[t] + 9 * other;
+        int n = 0;
+        while (n < size && row[cols[n]] == 0)
+            ++n;
+        best = std::max(best, n);
+    }
+    return best;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CANONICALFORM_HPP_
+#define CANONICALFORM_HPP_
+
+#include <vector>
+
+class Grid;
+
+/**
+ * An element of the symmetry group of sudoku: an optional transposition,
+ * a permutation of the rows which keeps the bands together, a permutation
+ * of the columns which keeps the stacks together and a relabeling of the
+ * digits.
+ *
+ * Cell (i, j) of the transformed grid is taken from row rows[i] and column
+ * cols[j] of the (transposed) original, its digit d becomes digits[d].
+ */
+class Transformation {
+private:
+    bool transposed;
+    unsigned char rows[9];
+    unsigned char cols[9];
+    unsigned char digits[10];
+    unsigned char inverse_rows[9];
+    unsigned char inverse_cols[9];
+    unsigned char inverse_digits[10];
+public:
+    /*! \brief creates the identity */
+    Transformation();
+    /**
+     * creates a transformation.
+     *
+     * @param transposed true if the grid is transposed first
+     * @param rows the source row of each row, bands must stay together
+     * @param cols the source column of each column, stacks must stay together
+     * @param digits the new digit of each digit 1..9 (digits[0] is ignored)
+     */
+    Transformation(bool transposed, const int *rows, const int *cols,
+            const int *digits);
+    /*! \brief returns the index of the cell which cell idx is moved to */
+    int map_cell(int idx) const;
+    /*! \brief returns the index of the original cell of the transformed cell idx */
+    int unmap_cell(int idx) const;
+    int map_value(int value) const;
+    int unmap_value(int value) const;
+    /*! \brief transforms the values of a grid */
+    void apply(const Grid &from, Grid &to) const;
+    /*! \brief transforms the values of a grid back, the inverse of apply */
+    void revert(const Grid &from, Grid &to) const;
+private:
+    void init_inverse();
+    friend class Canonicalizer;
+};
+
+/**
+ * Computes the canonical form of a puzzle: the lexicographically minimal
+ * grid (empty cells as 0, row by row) among all grids the puzzle can be
+ * transformed into by the 9! * 2 * 6^8 symmetries of sudoku.
+ *
+ * Puzzles which are transformations of each other have the same canonical
+ * form. The transformation found maps the puzzle onto its canonical form,
+ * so results computed for the canonical form can be mapped back.
+ *
+ * The search fixes the canonical grid row by row and keeps only the
+ * partial transformations producing the minimal rows so far; for the first
+ * row only the pattern of the givens matters, because the digits are
+ * relabeled in the order of their first appearance.
+ *
+ * Empty rows, columns, bands and stacks are interchangeable, swapping two
+ * of them yields the same grid. Only one order of them is tried, otherwise
+ * the ties of an (almost) empty grid would multiply the candidates.
+ *
+ * A canonicalizer keeps its buffers between calls, so it should be reused.
+ * It is not thread safe, use one per thread.
+ */
+class Canonicalizer {
+private:
+    struct Candidate {
+        bool transposed;
+        unsigned char rows[9];
+        unsigned char cols[9];
+        unsigned char digits[10];
+        unsigned char next_digit;
+        unsigned short used_rows;
+    };
+    unsigned char values[2][81];
+    /*! \brief the rows without givens of values[t] as bit masks */
+    unsigned empty_rows[2];
+    std::vector<Candidate> current;
+    std::vector<Candidate> next;
+public:
+    Canonicalizer();
+    /**
+     * computes the canonical form of the givens of a grid.
+     *
+     * @param grid the puzzle
+     * @param canonical receives the 81 digits of the canonical form (0 = empty)
+     * @param transformation receives a transformation mapping the grid
+     * onto its canonical form
+     */
+    void canonicalize(const Grid &grid, unsigned char *canonical,
+            Transformation &transformation);
+    void canonicalize(const Grid &grid, Grid &canonical,
+            Transformation &transformation);
+private:
+    void find_first_rows();
+    void find_row(int row);
+    bool is_redundant_row(int t, int r, unsigned used_rows) const;
+    int count_leading_empty(int t, int r, const unsigned char *cols,
+            int size) const;
+    Canonicalizer(const Canonicalizer &other) {
+    }
+    Canonicalizer &operator =(const Canonicalizer &other) {
+        return *this;
+    }
+};
+
+inline int Transformation::map_value(int value) const {
+    return digits[value];
+}
+
+inline int Transformation::unmap_value(int value) const {
+    return inverse_digits[value];
+}
+
+#endif /* CANONICALFORM_HPP_ */
@@ -52,15 +52,47 @@ const char *ClaimingRowHint::get_name() const {
     return "Claiming";
 }
 
+namespace {
+
+/*
+ * a claiming hint of a row or column (units 0-8 and 9-17) depends on the
+ * line and on the three blocks it crosses.
+ */
+struct LineDependencies {
+    unsigned lines[18];
+
+    LineDependencies() {
+        for (int i = 0; i < 9; ++i) {
+            lines[i] = 1u << i;
+            lines[9 + i] = 1u << (9 + i);
+            for (int j = 0; j < 3; ++j) {
+                lines[i] |= 1u << (18 + i / 3 * 3 + j);
+                lines[9 + i] |= 1u << (18 + j * 3 + i / 3);
+            }
+        }
+    }
+};
+
+const LineDependencies LINE_DEPENDENCIES;
+
+}
+
 void ClaimingHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
+    tracker.start(grid, LINE_DEPENDENCIES.lines, 18);
     for (int row = 0; row < 9; ++row) {
-        find_row_hint(row, grid, consumer);
+        if (tracker.is_clean(row))
+            continue;
+        if (!find_row_hint(row, grid, consumer))
+            tracker.set_clean(row);
         if (!consumer.wants_more_hints())
             return;
     }
 
     for (int col = 0; col < 9; ++col) {
-        find_col_hint(col, grid, consumer);
+        if (tracker.is_clean(9 + col))
+            continue;
+        if (!find_col_hint(col, grid, consumer))
+            tracker.set_clean(9 + col);
         if (!consumer.wants_more_hints())
             return;
     }
@@ -110,8 +142,12 @@ bool ClaimingHintProducer::check_block(const std::vector<Cell *> &cells,
     return false;
 }
 
-void ClaimingHintProducer::find_row_hint(int row, Grid &grid,
+/**
+ * returns true if a hint has been found for the row.
+ */
+bool ClaimingHintProducer::find_row_hint(int row, Grid &grid,
         HintConsumer &consumer) const {
+    bool found = false;
     const Range &range = RANGES.get_row(row);
     for (int value = 1; value < 10; ++value) {
         std::vector<std::vector<Cell *> > block_cells(3);
@@ -133,17 +169,23 @@ void ClaimingHintProducer::find_row_hint(int row, Grid &grid,
                     int block_idx = find_block_by(start_row, start_col);
                     if (!check_block(block_cells[i], block_idx, value, grid))
                         continue;
+                    found = true;
                     if (!consumer.consume_hint(create_row_hint(block_cells[i],
                             row, block_idx, value, grid)))
-                        return;
+                        return true;
                 }
             }
         }
     }
+    return found;
 }
 
-void ClaimingHintProducer::find_col_hint(int col, Grid &grid,
+/**
+ * returns true if a hint has been found for the column.
+ */
+bool ClaimingHintProducer::find_col_hint(int col, Grid &grid,
         HintConsumer &consumer) const {
+    bool found = false;
     const Range &range = RANGES.get_column(col);
     for (int value = 1; value < 10; ++value) {
         std::vector<std::vector<Cell *> > block_cells(3);
@@ -165,13 +207,15 @@ void ClaimingHintProducer::find_col_hint(int col, Grid &grid,
                     int block_idx = find_block_by(start_row, start_col);
                     if (!check_block(block_cells[i], block_idx, value, grid))
                         continue;
+                    found = true;
                     if (!consumer.consume_hint(create_column_hint(
                             block_cells[i], col, block_idx, value, grid)))
-                        return;
+                        return true;
                 }
             }
         }
     }
+    return found;
 }
 
 ClaimingRowHint *ClaimingHintProducer::create_row_hint(
@@ -34,6 +34,7 @@
 #define CLAIMING_HPP
 
 #include "indirecthint.hpp"
+#include "housetracker.hpp"
 
 #include <vector>
 
@@ -58,13 +59,19 @@ public:
     const char *get_name() const;
 };
 
+/**
+ * Finds claiming hints. A row or column searched without result is skipped
+ * until the choices of the line or of the blocks it crosses change.
+ */
 class ClaimingHintProducer : public HintProducer {
+private:
+    HouseTracker tracker;
 public:
     void find_hints(Grid &grid, HintConsumer &consumer);
 private:
     int find_block_by(int start_row, int start_col) const;
-    void find_row_hint(int row, Grid &grid, HintConsumer &consumer) const;
-    void find_col_hint(int col, Grid &grid, HintConsumer &consumer) const;
+    bool find_row_hint(int row, Grid &grid, HintConsumer &consumer) const;
+    bool find_col_hint(int col, Grid &grid, HintConsumer &consumer) const;
     bool check_block(const std::vector<Cell *> &cells, int block_idx, int value, Grid &grid) const;
     ClaimingRowHint *create_row_hint(std::vector<Cell *> &cells,int row, int block_idx, int value, Grid &grid) const;
     ClaimingColumnHint *create_column_hint(std::vector<Cell *> &cells,int row, int block_idx, int value, Grid &grid) const;
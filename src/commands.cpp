@@ -56,7 +56,7 @@ void SetValueCommand::redo() {
     Cell &cell = grid[idx];
     if (cell.has_value())
         grid.clear_cell_value(cell);
-    cell.set_value(value);
+    grid.set_cell_value(cell, value);
     grid.cleanup_choice(cell);
 }
 
@@ -80,11 +80,11 @@ RemoveChoiceCommand::RemoveChoiceCommand(Grid &grid, int value, int idx) :
 }
 
 void RemoveChoiceCommand::undo() {
-    grid[idx].add_choice(value);
+    grid.add_choice(grid[idx], value);
 }
 
 void RemoveChoiceCommand::redo() {
-    grid[idx].remove_choice(value);
+    grid.remove_choice(grid[idx], value);
 }
 
 AddChoiceCommand::AddChoiceCommand(Grid &grid, int value, int idx) :
@@ -92,11 +92,11 @@ AddChoiceCommand::AddChoiceCommand(Grid &grid, int value, int idx) :
 }
 
 void AddChoiceCommand::undo() {
-    grid[idx].remove_choice(value);
+    grid.remove_choice(grid[idx], value);
 }
 
 void AddChoiceCommand::redo() {
-    grid[idx].add_choice(value);
+    grid.add_choice(grid[idx], value);
 }
 
 SolveSinglesCommand::SolveSinglesCommand(Grid &grid) :
@@ -33,6 +33,8 @@
 #ifndef COMMANDS_HPP
 #define COMMANDS_HPP
 
+#include <vector>
+
 #include "grid.hpp"
 
 /*!
@@ -30,118 +30,361 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <iostream>
 #include <vector>
-#include <string>
 #include <limits>
-#include <algorithm>
+#include <chrono>
 #include "dancinglinks.hpp"
-#include "util.hpp"
 
 Solver::Solver(NodeFactory *node_factory, SolutionListener *solution_listener) :
     node_factory(node_factory), head(node_factory->create_column(-1)),
-            solution_listener(solution_listener) {
+            solution_listener(solution_listener), num_columns(0),
+            state(STATE_IDLE), depth(0), limit(0), report(false),
+            nodes_visited(0), nodes(0), sizes(0) {
+    count.count = 0;
+    count.limit_reached = false;
+    count.budget_exhausted = false;
 }
 
-Column * Solver::add_column(int idx) {
-    Column *column = node_factory->create_column(idx);
-    Node *left = head->get_left();
-    left->set_right(column);
-    column->set_left(left);
-    column->set_right(head);
-    head->set_left(column);
+Solver::Solver(NodeFactory *node_factory, const Solver &other,
+        SolutionListener *solution_listener) :
+    node_factory(node_factory), head(other.head), solution_listener(
+            solution_listener), selected(other.selected), undo_log(
+            other.undo_log), num_columns(other.num_columns), state(STATE_IDLE),
+            depth(0), limit(0), report(false), nodes_visited(0), nodes(0),
+            sizes(0) {
+    count.count = 0;
+    count.limit_reached = false;
+    count.budget_exhausted = false;
+}
+
+int Solver::add_column(int idx) {
+    NodeFactory &f = *node_factory;
+    int column = f.create_column(idx);
+    int left = f[head].get_left();
+    f[left].set_right(column);
+    f[column].set_left(left);
+    f[column].set_right(head);
+    f[head].set_left(column);
+    ++num_columns;
     return column;
 }
 
+void Solver::remove_row(int node) {
+    attach();
+    int j = node;
+    do {
+        Node &n = nodes[j];
+        nodes[n.get_down()].set_up(n.get_up());
+        nodes[n.get_up()].set_down(n.get_down());
+        --sizes[n.get_column()];
+        j = n.get_right();
+    } while (j != node);
+    undo_log.push_back(~node);
+}
+
+void Solver::restore_row(int node) {
+    int j = node;
+    do {
+        j = nodes[j].get_left();
+        Node &n = nodes[j];
+        ++sizes[n.get_column()];
+        nodes[n.get_down()].set_up(j);
+        nodes[n.get_up()].set_down(j);
+    } while (j != node);
+}
+
+bool Solver::select_row(int node) {
+    attach();
+    int j = node;
+    do {
+        int column = nodes[j].get_column();
+        if (nodes[nodes[column].get_left()].get_right() != column)
+            return false; // conflicts with a row selected before
+        j = nodes[j].get_right();
+    } while (j != node);
+
+    do {
+        cover(nodes[j].get_column());
+        j = nodes[j].get_right();
+    } while (j != node);
+    selected.push_back(node);
+    undo_log.push_back(node);
+    return true;
+}
+
+void Solver::unselect_row(int node) {
+    int j = node;
+    do {
+        j = nodes[j].get_left();
+        uncover(nodes[j].get_column());
+    } while (j != node);
+    selected.pop_back();
+}
+
+void Solver::reset() {
+    rollback(0);
+}
+
+void Solver::rollback(int mark) {
+    attach();
+    abort();
+    while ((int) undo_log.size() > mark) {
+        int node = undo_log.back();
+        undo_log.pop_back();
+        if (node < 0)
+            restore_row(~node);
+        else
+            unselect_row(node);
+    }
+}
+
+void Solver::split(int levels, std::vector<std::vector<int> > &prefixes) {
+    std::vector<int> prefix;
+
+    attach();
+    abort();
+    split(levels, prefix, prefixes);
+}
+
+void Solver::split(int levels, std::vector<int> &prefix, std::vector<
+        std::vector<int> > &prefixes) {
+    if (levels == 0 || nodes[head].get_right() == head) {
+        prefixes.push_back(prefix);
+        return;
+    }
+    int column = choose_column();
+    for (int row = nodes[column].get_down(); row != column; row
+            = nodes[row].get_down()) {
+        int mark = get_undo_mark();
+        select_row(row);
+        prefix.push_back(row);
+        split(levels - 1, prefix, prefixes);
+        prefix.pop_back();
+        rollback(mark);
+    }
+}
+
 bool Solver::solve() {
-    if (head->get_right() == head) {
-        return solution_listener->solution_found(result);
+    start(0, true);
+    run();
+    return count.limit_reached;
+}
+
+SolutionCount Solver::count_solutions(int limit) {
+    start(limit, false);
+    run();
+    return count;
+}
+
+void Solver::start(int limit, bool report) {
+    attach();
+    abort();
+    /*
+     * every row on the stack covers at least one column
+     */
+    stack.resize(num_columns);
+    first_solution.clear();
+    count.count = 0;
+    count.limit_reached = false;
+    count.budget_exhausted = false;
+    nodes_visited = 0;
+    depth = 0;
+    this->limit = limit;
+    this->report = report;
+    state = STATE_ENTER;
+}
+
+SearchStatus Solver::run(long max_nodes, double max_seconds) {
+    long max_visited = max_nodes > 0 ? nodes_visited + max_nodes : -1;
+    std::chrono::steady_clock::time_point deadline;
+    if (max_seconds > 0) {
+        deadline = std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<
+                        std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(max_seconds));
     }
-    Column *column = choose_column();
-    cover(column);
-    Node *row = column->get_down();
-    while (row != column) {
-        result.push_back(row);
-        Node *row_column = row->get_right();
-        while (row_column != row) {
-            cover(row_column->get_column());
-            row_column = row_column->get_right();
+
+    attach();
+    count.budget_exhausted = false;
+    for (;;) {
+        switch (state) {
+        case STATE_ENTER:
+            if (nodes[head].get_right() == head) {
+                if (record_solution()) {
+                    abort();
+                    return SEARCH_FINISHED;
+                }
+                state = STATE_BACKTRACK;
+            } else {
+                int column = choose_column();
+                if (sizes[column] == 0) {
+                    state = STATE_BACKTRACK;
+                } else {
+                    cover(column);
+                    stack[depth].column = column;
+                    stack[depth].row = nodes[column].get_down();
+                    state = STATE_TRY_ROW;
+                }
+            }
+            break;
+        case STATE_TRY_ROW: {
+            Frame &frame = stack[depth];
+            if (frame.row == frame.column) {
+                uncover(frame.column);
+                state = STATE_BACKTRACK;
+                break;
+            }
+            int row_column = nodes[frame.row].get_right();
+            while (row_column != frame.row) {
+                cover(nodes[row_column].get_column());
+                row_column = nodes[row_column].get_right();
+            }
+            ++depth;
+            ++nodes_visited;
+            state = STATE_ENTER;
+            if (nodes_visited == max_visited || (max_seconds > 0
+                    && (nodes_visited & 1023) == 0
+                    && std::chrono::steady_clock::now() >= deadline)) {
+                count.budget_exhausted = true;
+                return SEARCH_SUSPENDED;
+            }
+            break;
+        }
+        case STATE_BACKTRACK: {
+            if (depth == 0) {
+                state = STATE_IDLE;
+                return SEARCH_FINISHED;
+            }
+            --depth;
+            Frame &frame = stack[depth];
+            int row_column = nodes[frame.row].get_left();
+            while (row_column != frame.row) {
+                uncover(nodes[row_column].get_column());
+                row_column = nodes[row_column].get_left();
+            }
+            frame.row = nodes[frame.row].get_down();
+            state = STATE_TRY_ROW;
+            break;
         }
-        if(solve())
+        case STATE_IDLE:
+            return SEARCH_FINISHED;
+        }
+    }
+}
+
+void Solver::abort() {
+    if (state != STATE_IDLE) {
+        unwind();
+        state = STATE_IDLE;
+    }
+}
+
+bool Solver::record_solution() {
+    if (count.count == 0) {
+        for (std::vector<int>::const_iterator i = selected.begin(); i
+                != selected.end(); ++i) {
+            first_solution.push_back(nodes[*i].get_row());
+        }
+        for (int i = 0; i < depth; ++i) {
+            first_solution.push_back(nodes[stack[i].row].get_row());
+        }
+    }
+    ++count.count;
+
+    if (report) {
+        result.clear();
+        for (std::vector<int>::const_iterator i = selected.begin(); i
+                != selected.end(); ++i) {
+            result.push_back(nodes + *i);
+        }
+        for (int i = 0; i < depth; ++i) {
+            result.push_back(nodes + stack[i].row);
+        }
+        if (solution_listener->solution_found(result)) {
+            count.limit_reached = true;
             return true;
-        result.pop_back();
-        row_column = row->get_left();
-        while (row_column != row) {
-            uncover(row_column->get_column());
-            row_column = row_column->get_left();
         }
-        row = row->get_down();
     }
-    uncover(column);
+
+    if (limit > 0 && count.count >= limit) {
+        count.limit_reached = true;
+        return true;
+    }
     return false;
 }
 
-void Solver::cover(Column *column) {
-    column->get_right()->set_left(column->get_left());
-    column->get_left()->set_right(column->get_right());
-    Node *i = column->get_down();
+void Solver::unwind() {
+    /*
+     * the frame at depth has not covered anything yet
+     */
+    while (depth > 0) {
+        --depth;
+        Frame &frame = stack[depth];
+        int row_column = nodes[frame.row].get_left();
+        while (row_column != frame.row) {
+            uncover(nodes[row_column].get_column());
+            row_column = nodes[row_column].get_left();
+        }
+        uncover(frame.column);
+    }
+}
+
+void Solver::cover(int column) {
+    Node &c = nodes[column];
+    nodes[c.get_right()].set_left(c.get_left());
+    nodes[c.get_left()].set_right(c.get_right());
+    int i = c.get_down();
     while (i != column) {
-        Node *j = i->get_right();
+        int j = nodes[i].get_right();
         while (j != i) {
-            j->get_down()->set_up(j->get_up());
-            j->get_up()->set_down(j->get_down());
-            j->get_column()->set_size(j->get_column()->get_size() - 1);
-            j = j->get_right();
+            Node &n = nodes[j];
+            nodes[n.get_down()].set_up(n.get_up());
+            nodes[n.get_up()].set_down(n.get_down());
+            --sizes[n.get_column()];
+            j = n.get_right();
         }
-        i = i->get_down();
+        i = nodes[i].get_down();
     }
 }
 
-void Solver::uncover(Column *column) {
-    Node *i = column->get_up();
+void Solver::uncover(int column) {
+    Node &c = nodes[column];
+    int i = c.get_up();
     while (i != column) {
-        Node *j = i->get_left();
+        int j = nodes[i].get_left();
         while (j != i) {
-            j->get_column()->set_size(j->get_column()->get_size() + 1);
-            j->get_down()->set_up(j);
-            j->get_up()->set_down(j);
-            j = j->get_left();
+            Node &n = nodes[j];
+            ++sizes[n.get_column()];
+            nodes[n.get_down()].set_up(j);
+            nodes[n.get_up()].set_down(j);
+            j = n.get_left();
         }
-        i = i->get_up();
+        i = nodes[i].get_up();
     }
-    column->get_left()->set_right(column);
-    column->get_right()->set_left(column);
+    nodes[c.get_left()].set_right(column);
+    nodes[c.get_right()].set_left(column);
 }
 
-Column *Solver::choose_column() {
+int Solver::choose_column() const {
     int min = std::numeric_limits<int>::max();
-    Node *found = 0;
-    Node *c = head->get_right();
+    int found = -1;
+    int c = nodes[head].get_right();
     while (c != head) {
-        if (c->get_column()->get_size() < min) {
-            min = c->get_column()->get_size();
+        if (sizes[c] < min) {
+            min = sizes[c];
             found = c;
-            if(min == 1) {
+            if (min == 1) {
                 /*
                  * the solution cannot get better.
                  * on my machine it is faster to have the
                  * extra comparison here.
                  */
-                return found->get_column();
+                return found;
             }
         }
-        c = c->get_right();
+        c = nodes[c].get_right();
     }
-    return found ? found->get_column() : 0;
-}
-
-void Column::add_child(Node *node) {
-    Node *up = get_up();
-    up->set_down(node);
-    node->set_up(up);
-    node->set_down(this);
-    this->set_up(node);
-    ++size;
+    return found;
 }
 
 SolutionListener::~SolutionListener() {
@@ -149,5 +392,4 @@ SolutionListener::~SolutionListener() {
 }
 
 NodeFactory::~NodeFactory() {
-    std::for_each(nodes.begin(), nodes.end(), destroy<Node *> ());
 }
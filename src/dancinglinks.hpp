@@ -34,66 +34,61 @@
 #define DANCINGLINKS_HPP_
 
 #include <vector>
+#include "solutioncount.hpp"
 
-#ifdef _MSCVER
-#pragma warning(disable:4355)
-#endif
-
-class NodeFactory;
-class Column;
+/**
+ * A node of the dancing links matrix. All nodes live in the contiguous pool
+ * of a NodeFactory and refer to each other by their index in that pool.
+ * Column headers are nodes whose column is the node itself; their row is the
+ * column index.
+ */
 class Node {
     int row;
-    Node *left;
-    Node *right;
-    Node *up;
-    Node *down;
-    Column *column;
+    int left;
+    int right;
+    int up;
+    int down;
+    int column;
 public:
-    Node(Column *column, int row = -1);
+    Node(int self, int column, int row = -1);
     int get_row() const;
-    const Node *get_left() const;
-    const Node *get_right() const;
-    const Node *get_up() const;
-    const Node *get_down() const;
-    const Column *get_column() const;
-    Node *get_left();
-    Node *get_right();
-    Node *get_up();
-    Node *get_down();
-    Column *get_column();
-    void set_left(Node *node);
-    void set_right(Node *node);
-    void set_up(Node *node);
-    void set_down(Node *node);
-    void set_column(Column *column);
-    void add_sibling(Node *node);
-private:
-    Node(const Node &other) {
-    }
-    Node &operator =(const Node &other) {
-        return *this;
-    }
-};
-
-class Column: public Node {
-    int size;
-public:
-    Column(int idx = -1);
-    int get_size() const;
-    void set_size(int size);
-    void add_child(Node *node);
-    Node *create_child(int row);
+    int get_left() const;
+    int get_right() const;
+    int get_up() const;
+    int get_down() const;
+    int get_column() const;
+    void set_left(int node);
+    void set_right(int node);
+    void set_up(int node);
+    void set_down(int node);
+    void set_column(int column);
 };
 
+/**
+ * Owns the node pool. The pool only grows while the matrix is built, so
+ * pointers into it stay valid during a search. clear() keeps the capacity,
+ * so rebuilding a matrix of the same size does not allocate.
+ */
 class NodeFactory {
 private:
-    std::vector<Node *> nodes;
+    std::vector<Node> nodes;
+    std::vector<int> sizes;
 public:
     NodeFactory();
     virtual ~NodeFactory();
-    Node *create_node(Column *column, int row = -1);
-    Node *create_child(Column *column, int row = -1);
-    Column *create_column(int row = -1);
+    /*! \brief makes this pool a copy of other */
+    void assign(const NodeFactory &other);
+    void reserve(int num_nodes);
+    void clear();
+    int create_node(int column, int row = -1);
+    int create_child(int column, int row = -1);
+    int create_column(int row = -1);
+    void add_sibling(int node, int sibling);
+    Node &operator[](int idx);
+    const Node &operator[](int idx) const;
+    int get_size(int column) const;
+    Node *get_nodes();
+    int *get_sizes();
 private:
     NodeFactory(const NodeFactory &other) {
     }
@@ -109,30 +104,118 @@ public:
     virtual bool solution_found(const std::vector<Node *> &rows) = 0;
 };
 
+enum SearchStatus {
+    SEARCH_FINISHED, SEARCH_SUSPENDED
+};
+
+/**
+ * Exact cover search on the matrix of a NodeFactory.
+ *
+ * A matrix can be reused for several problems: rows that are not part of
+ * a problem are taken out with remove_row(), rows that are known to be
+ * part of every solution (the clues) are taken with select_row(). reset()
+ * undoes both in reverse order and restores the original matrix.
+ *
+ * The search is iterative and keeps its state in an explicit stack of
+ * frames, so it can be suspended and resumed: start() prepares a search,
+ * run() continues it until it is finished or the node or time budget of
+ * the call is used up. A suspended search keeps the matrix covered until it
+ * is finished or abort()ed.
+ *
+ * solve() reports every solution to the SolutionListener. count_solutions()
+ * does not need a listener; it stops as soon as the limit is reached and
+ * remembers the rows of the first solution.
+ */
 class Solver {
+    struct Frame {
+        int column;
+        int row;
+    };
+    enum SearchState {
+        STATE_IDLE, STATE_ENTER, STATE_TRY_ROW, STATE_BACKTRACK
+    };
+
     NodeFactory *node_factory;
-    Column *head;
+    int head;
     SolutionListener *solution_listener;
+    std::vector<int> selected;
     std::vector<Node *> result;
+    std::vector<int> undo_log;
+    std::vector<Frame> stack;
+    std::vector<int> first_solution;
+    int num_columns;
+    SearchState state;
+    int depth;
+    int limit;
+    bool report;
+    SolutionCount count;
+    long nodes_visited;
+    Node *nodes;
+    int *sizes;
 public:
-    Solver(NodeFactory *node_factory, SolutionListener *solution_listener);
-    Column *add_column(int idx);
-    Column *get_head();
-    const Column *get_head() const;
+    Solver(NodeFactory *node_factory, SolutionListener *solution_listener = 0);
+    /*! \brief creates a solver for node_factory, which holds a copy of the matrix of other */
+    Solver(NodeFactory *node_factory, const Solver &other,
+            SolutionListener *solution_listener);
+    int add_column(int idx);
+    int get_head() const;
+    void remove_row(int node);
+    bool select_row(int node);
+    void reset();
+    int get_undo_mark() const;
+    /*! \brief undoes the remove_row()/select_row() calls made after mark was taken */
+    void rollback(int mark);
+    /*!
+     * \brief expands the first levels of the search tree
+     *
+     * Each prefix is a list of row nodes which, selected in order, yield one
+     * independent subproblem. Together the subproblems cover the whole search.
+     */
+    void split(int levels, std::vector<std::vector<int> > &prefixes);
     bool solve();
+    /*! \brief counts up to limit solutions, limit <= 0 counts all */
+    SolutionCount count_solutions(int limit);
+    /*! \brief row numbers of the first solution of the last search */
+    const std::vector<int> &get_first_solution() const;
+
+    /*! \brief prepares a search for up to limit solutions, report calls the listener */
+    void start(int limit, bool report);
+    /**
+     * continues the search until it is finished or the budget of this call
+     * runs out.
+     *
+     * @param max_nodes the number of nodes to visit, <= 0 means no limit
+     * @param max_seconds the wall clock time (steady_clock) to run, <= 0
+     * means no limit. like ParallelSolver the time of the search itself is
+     * measured, not the cpu time of the process, so other threads do not
+     * use up the budget.
+     */
+    SearchStatus run(long max_nodes = 0, double max_seconds = 0);
+    /*! \brief ends a suspended search and restores the matrix */
+    void abort();
+    const SolutionCount &get_count() const;
+    long get_nodes_visited() const;
+    int get_depth() const;
 private:
     Solver(const Solver &other) {
     }
     Solver &operator =(const Solver &other) {
         return *this;
     }
-    void cover(Column *column);
-    void uncover(Column *column);
-    Column *choose_column();
+    void attach();
+    void split(int levels, std::vector<int> &prefix,
+            std::vector<std::vector<int> > &prefixes);
+    bool record_solution();
+    void unwind();
+    void cover(int column);
+    void uncover(int column);
+    void unselect_row(int node);
+    void restore_row(int node);
+    int choose_column() const;
 };
 
-inline Node::Node(Column *column, int row) :
-    row(row), left(this), right(this), up(this), down(this), column(column) {
+inline Node::Node(int self, int column, int row) :
+    row(row), left(self), right(self), up(self), down(self), column(column) {
 
 }
 
@@ -140,111 +223,146 @@ inline int Node::get_row() const {
     return row;
 }
 
-inline const Node *Node::get_left() const {
+inline int Node::get_left() const {
     return left;
 }
 
-inline const Node *Node::get_right() const {
+inline int Node::get_right() const {
     return right;
 }
 
-inline const Node *Node::get_up() const {
+inline int Node::get_up() const {
     return up;
 }
 
-inline const Node *Node::get_down() const {
+inline int Node::get_down() const {
     return down;
 }
 
-inline const Column *Node::get_column() const {
+inline int Node::get_column() const {
     return column;
 }
 
-inline Node *Node::get_left() {
-    return left;
+inline void Node::set_left(int left) {
+    this->left = left;
 }
 
-inline Node *Node::get_right() {
-    return right;
+inline void Node::set_right(int right) {
+    this->right = right;
 }
 
-inline Node *Node::get_up() {
-    return up;
+inline void Node::set_up(int up) {
+    this->up = up;
 }
 
-inline Node *Node::get_down() {
-    return down;
+inline void Node::set_down(int down) {
+    this->down = down;
 }
 
-inline Column::Column(int idx) :
-    Node(this, idx), size(0) {
+inline void Node::set_column(int column) {
+    this->column = column;
 }
 
-inline Column *Node::get_column() {
-    return column;
+inline int Solver::get_head() const {
+    return head;
 }
 
-inline void Node::set_left(Node *left) {
-    this->left = left;
+inline const std::vector<int> &Solver::get_first_solution() const {
+    return first_solution;
 }
 
-inline void Node::set_right(Node *right) {
-    this->right = right;
+inline int Solver::get_undo_mark() const {
+    return undo_log.size();
 }
 
-inline void Node::set_up(Node *up) {
-    this->up = up;
+inline const SolutionCount &Solver::get_count() const {
+    return count;
 }
 
-inline void Node::set_down(Node *down) {
-    this->down = down;
+inline long Solver::get_nodes_visited() const {
+    return nodes_visited;
 }
 
-inline void Node::set_column(Column *column) {
-    this->column = column;
+inline int Solver::get_depth() const {
+    return depth;
 }
 
-inline void Node::add_sibling(Node *node) {
-    left->set_right(node);
-    node->set_left(left);
-    this->set_left(node);
-    node->set_right(this);
+inline void Solver::attach() {
+    /*
+     * the pool does not change after the matrix has been built, so the
+     * raw arrays can be used directly.
+     */
+    nodes = node_factory->get_nodes();
+    sizes = node_factory->get_sizes();
 }
 
-inline int Column::get_size() const {
-    return size;
+inline NodeFactory::NodeFactory() {
 }
 
-inline void Column::set_size(int size) {
-    this->size = size;
+inline void NodeFactory::reserve(int num_nodes) {
+    nodes.reserve(num_nodes);
+    sizes.reserve(num_nodes);
 }
 
-inline Column *Solver::get_head() {
-    return head;
+inline void NodeFactory::assign(const NodeFactory &other) {
+    nodes = other.nodes;
+    sizes = other.sizes;
 }
 
-inline const Column *Solver::get_head() const {
-    return head;
+inline void NodeFactory::clear() {
+    nodes.clear();
+    sizes.clear();
 }
 
-inline NodeFactory::NodeFactory() {
+inline int NodeFactory::create_node(int column, int row) {
+    int idx = nodes.size();
+    nodes.push_back(Node(idx, column, row));
+    sizes.push_back(0);
+    return idx;
 }
 
-inline Node *NodeFactory::create_node(Column *column, int row) {
-    Node *node = new Node(column, row);
-    nodes.push_back(node);
+inline int NodeFactory::create_child(int column, int row) {
+    int node = create_node(column, row);
+    int up = nodes[column].get_up();
+    nodes[up].set_down(node);
+    nodes[node].set_up(up);
+    nodes[node].set_down(column);
+    nodes[column].set_up(node);
+    ++sizes[column];
     return node;
 }
-inline Node *NodeFactory::create_child(Column *column, int row) {
-    Node *node = create_node(column, row);
-    column->add_child(node);
-    return node;
+
+inline int NodeFactory::create_column(int row) {
+    int idx = nodes.size();
+    return create_node(idx, row);
 }
 
-inline Column *NodeFactory::create_column(int row) {
-    Column *column = new Column(row);
-    nodes.push_back(column);
-    return column;
+inline void NodeFactory::add_sibling(int node, int sibling) {
+    int left = nodes[node].get_left();
+    nodes[left].set_right(sibling);
+    nodes[sibling].set_left(left);
+    nodes[node].set_left(sibling);
+    nodes[sibling].set_right(node);
+}
+
+inline Node &NodeFactory::operator[](int idx) {
+    return nodes[idx];
+}
+
+inline const Node &NodeFactory::operator[](int idx) const {
+    return nodes[idx];
+}
+
+inline int NodeFactory::get_size(int column) const {
+    return sizes[column];
+}
+
+inline Node *NodeFactory::get_nodes() {
+    return &nodes[0];
+}
+
+inline int *NodeFactory::get_sizes() {
+    return &sizes[0];
 }
 
 #endif
@@ -1,59 +1,558 @@
 #include <memory>
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cctype>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
 
 #include "grid.hpp"
 #include "dlxsolver.hpp"
+#include "puzzlesource.hpp"
+#include "puzzlearchive.hpp"
+#include "canonicalform.hpp"
+#include "solutioncache.hpp"
+#include "reorderbuffer.hpp"
 
 class MySolutionListener: public SolutionListener {
 public:
     bool solution_found(const std::vector<Node *> &rows);
 };
 
-bool MySolutionListener::solution_found(const std::vector<Node *> &rows) {
+void print_solution(const Grid &solution) {
+    std::cout << std::endl;
+    solution.print(std::cout);
     std::cout << std::endl;
+}
+
+bool MySolutionListener::solution_found(const std::vector<Node *> &rows) {
     Grid grid;
     for (std::vector<Node *>::const_iterator i = rows.begin(); i != rows.end(); ++i) {
         int idx = (*i)->get_row();
         int value = idx % 9 + 1;
         idx /= 9;
-        grid[idx].set_value(value);
-        grid[idx].clear_choices();
+        grid.set_cell_value(grid[idx], value);
+        grid.clear_choices(grid[idx]);
     }
-    grid.print(std::cout);
-    std::cout << std::endl;
+    print_solution(grid);
     return false;
 }
 
-void solve(const std::string &s) {
-    std::auto_ptr<MySolutionListener> p(new MySolutionListener());
-
-    std::istringstream in(s);
+void solve(const char *line, const char *line_end,
+        DlxSudokuSolver &dlx_solver, SolverEngine *engine) {
     Grid grid;
-    grid.load(in);
+    if (!grid.load(line, line_end))
+        return;
     grid.print(std::cout);
     std::cout << std::endl;
-    DlxSudokuSolver solver(p.get());
-    solver.solve(grid);
+    if (engine) {
+        Grid solution;
+        if (engine->find_first(grid, solution).count > 0)
+            print_solution(solution);
+    } else {
+        dlx_solver.solve(grid);
+    }
+}
+
+enum BatchMode {
+    MODE_FIRST, MODE_COUNT, MODE_UNIQUE
+};
+
+struct BatchOptions {
+    EngineType engine_type;
+    BatchMode mode;
+    int limit;
+    /*! \brief threads per search of the dlx engine in count and unique mode */
+    int search_threads;
+    /*! \brief nodes per puzzle, 0 for no limit */
+    long max_nodes;
+    /*! \brief seconds per puzzle, 0 for no limit */
+    double max_seconds;
+    SolutionCache *cache;
+};
+
+struct BatchChunk {
+    std::string output;
+    int count;
+    int aborted;
+};
+
+std::string get_digits(const Grid &grid) {
+    std::string digits(81, '0');
+    for (int i = 0; i < 81; ++i) {
+        digits[i] = '0' + grid[i].get_value();
+    }
+    return digits;
+}
+
+/**
+ * solves one puzzle and prints the result as a single line:
+ * the puzzle followed by the solution (first), the number of solutions
+ * (count) or unique/multiple/none (unique).
+ *
+ * a search that runs out of its node or time budget is reported as
+ * aborted instead of none, the puzzle may still have a solution.
+ * returns false in this case.
+ *
+ * with a cache the first solution and the number of solutions are looked
+ * up by the canonical form of the puzzle. a cached solution of a puzzle
+ * with several solutions need not be the one the engine finds first.
+ * aborted searches are not cached.
+ */
+bool solve_line(const char *line, const char *line_end, SolverEngine &engine,
+        Canonicalizer &canonicalizer, const BatchOptions &options,
+        std::ostream &out) {
+    Grid grid;
+
+    if (!grid.load(line, line_end)) {
+        out.write(line, line_end - line);
+        out << " invalid\n";
+        return true;
+    }
+    grid.println(out);
+    out << ' ';
+
+    std::string key;
+    Transformation transformation;
+    CacheEntry entry;
+    bool cached = false;
+    bool aborted = false;
+    if (options.cache && options.mode != MODE_COUNT) {
+        unsigned char canonical[81];
+        canonicalizer.canonicalize(grid, canonical, transformation);
+        key = SolutionCache::make_key(canonical);
+        cached = options.cache->lookup(key, entry);
+    }
+
+    switch (options.mode) {
+    case MODE_FIRST: {
+        Grid solution;
+        bool found;
+        if (cached && !entry.solution.empty()) {
+            Grid canonical_solution;
+            canonical_solution.load(entry.solution.data(), entry.solution.data()
+                    + entry.solution.size());
+            transformation.revert(canonical_solution, solution);
+            found = true;
+        } else if (cached && entry.solutions == 0) {
+            found = false;
+        } else {
+            SolutionCount count = engine.find_first(grid, solution,
+                    options.max_nodes, options.max_seconds);
+            found = count.count > 0;
+            aborted = !found && count.budget_exhausted;
+            if (!key.empty() && !aborted) {
+                CacheEntry result;
+                if (found) {
+                    Grid canonical_solution;
+                    transformation.apply(solution, canonical_solution);
+                    result.solution = get_digits(canonical_solution);
+                } else {
+                    result.solutions = 0;
+                }
+                options.cache->store(key, result);
+            }
+        }
+        if (found)
+            solution.println(out);
+        else if (aborted)
+            out << "aborted";
+        else
+            out << "none";
+        break;
+    }
+    case MODE_COUNT: {
+        SolutionCount count = engine.count_solutions(grid, options.limit,
+                options.max_nodes, options.max_seconds);
+        aborted = count.budget_exhausted;
+        if (aborted) {
+            out << "aborted";
+        } else {
+            out << count.count;
+            if (count.limit_reached)
+                out << '+';
+        }
+        break;
+    }
+    case MODE_UNIQUE: {
+        int count;
+        if (cached && entry.solutions != CacheEntry::UNKNOWN) {
+            count = entry.solutions;
+        } else {
+            SolutionCount result = engine.count_solutions(grid, 2,
+                    options.max_nodes, options.max_seconds);
+            count = result.count;
+            aborted = count < 2 && result.budget_exhausted;
+            if (!key.empty() && !aborted) {
+                CacheEntry result;
+                result.solutions = count;
+                options.cache->store(key, result);
+            }
+        }
+        if (aborted)
+            out << "aborted";
+        else
+            out << (count == 0 ? "none" : count == 1 ? "unique" : "multiple");
+        break;
+    }
+    }
+
+    out << '\n';
+    return !aborted;
+}
+
+/**
+ * solves the chunks of the puzzle file until none is left. the chunks are
+ * taken in ascending order, the results are passed on in the same order.
+ *
+ * the chunks of a text file are byte ranges, the chunks of an archive
+ * are index ranges.
+ */
+void solve_chunks(const PuzzleSource *source,
+        const PuzzleArchiveReader *archive,
+        const std::vector<size_t> *offsets, std::atomic<int> *next_chunk,
+        ReorderBuffer<BatchChunk> *results, const BatchOptions *options) {
+    std::unique_ptr<SolverEngine> engine;
+    if (options->search_threads > 1) {
+        DlxSudokuSolver *dlx_solver = new DlxSudokuSolver();
+        dlx_solver->set_num_threads(options->search_threads);
+        engine.reset(dlx_solver);
+    } else {
+        engine.reset(create_solver_engine(options->engine_type));
+    }
+    Canonicalizer canonicalizer;
+    int chunks = offsets->size() - 1;
+    int index;
+    while ((index = next_chunk->fetch_add(1)) < chunks) {
+        size_t begin = (*offsets)[index];
+        size_t end = (*offsets)[index + 1];
+        std::ostringstream out;
+        BatchChunk chunk;
+        chunk.count = 0;
+        chunk.aborted = 0;
+        if (archive) {
+            char puzzle[81];
+            size_t offset = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if ((i == begin && !archive->get_offset(i, offset))
+                        || !archive->read(offset, puzzle)) {
+                    out << "record " << i << " invalid\n";
+                    ++chunk.count;
+                    break;
+                }
+                if (!solve_line(puzzle, puzzle + 81, *engine, canonicalizer,
+                        *options, out))
+                    ++chunk.aborted;
+                ++chunk.count;
+            }
+        } else {
+            PuzzleReader reader(*source, begin, end);
+            const char *line;
+            const char *line_end;
+            while (reader.next(line, line_end)) {
+                if (!solve_line(line, line_end, *engine, canonicalizer,
+                        *options, out))
+                    ++chunk.aborted;
+                ++chunk.count;
+            }
+        }
+        chunk.output = out.str();
+        results->put(index, chunk);
+    }
+    results->finish();
+}
+
+/**
+ * solves the puzzles on num_threads worker threads and prints one line per
+ * puzzle in input order, followed by a summary line.
+ *
+ * the puzzle file is split into chunks at line boundaries, each worker
+ * parses the lines of its chunks directly from the mapped file.
+ */
+int solve_batch(const PuzzleSource &source, const PuzzleArchiveReader *archive,
+        int num_threads, const BatchOptions &options) {
+    std::vector<size_t> offsets;
+    if (archive) {
+        size_t count = archive->get_count();
+        size_t chunks = std::max<size_t>(16 * num_threads, count / 1024 + 1);
+        offsets.resize(chunks + 1);
+        for (size_t i = 0; i <= chunks; ++i) {
+            offsets[i] = count * i / chunks;
+        }
+    } else {
+        source.split(std::max<size_t>(16 * num_threads, source.get_size()
+                / 65536 + 1), offsets);
+    }
+    std::atomic<int> next_chunk(0);
+    ReorderBuffer<BatchChunk> results(num_threads, 4 * num_threads);
+    std::vector<std::thread> threads;
+
+    std::chrono::steady_clock::time_point t1 =
+            std::chrono::steady_clock::now();
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread(solve_chunks, &source, archive,
+                &offsets, &next_chunk, &results, &options));
+    }
+
+    /*
+     * the output is written in large blocks instead of flushing
+     * every line.
+     */
+    std::string buffer;
+    BatchChunk chunk;
+    int count = 0;
+    int aborted = 0;
+    while (results.take(chunk)) {
+        buffer += chunk.output;
+        count += chunk.count;
+        aborted += chunk.aborted;
+        if (buffer.size() >= 1 << 16) {
+            std::cout.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    std::cout.write(buffer.data(), buffer.size());
+
+    for (std::vector<std::thread>::iterator t = threads.begin(); t
+            != threads.end(); ++t) {
+        t->join();
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - t1;
+    std::cout << count << " puzzles threads: " << num_threads << " time: "
+            << wall.count() << " seconds (" << (wall.count() > 0 ? count
+            / wall.count() : 0) << " puzzles/second)" << std::endl;
+    if (options.max_nodes > 0 || options.max_seconds > 0) {
+        std::cout << "aborted: " << aborted << " puzzles over budget"
+                << std::endl;
+    }
+    if (options.cache) {
+        std::cout << "cache hits: " << options.cache->get_hits()
+                << " misses: " << options.cache->get_misses() << " entries: "
+                << options.cache->get_size() << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * converts a text puzzle file into a binary archive.
+ *
+ * with ARCHIVE_SOLUTIONS the first solution found by the engine is stored,
+ * with ARCHIVE_RATINGS the number following the puzzle on each line.
+ */
+int convert(const PuzzleSource &source, const std::string &filename,
+        int flags, EngineType engine_type) {
+    PuzzleArchiveWriter writer;
+    if (!writer.open(filename, flags)) {
+        std::cerr << "cannot create file " << filename << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<SolverEngine> engine(create_solver_engine(engine_type));
+    PuzzleReader reader(source, 0, source.get_size());
+    const char *line;
+    const char *line_end;
+    int count = 0;
+    while (reader.next(line, line_end)) {
+        Grid grid;
+        if (!grid.load(line, line_end))
+            continue;
+
+        Grid solution;
+        bool solved = (flags & ARCHIVE_SOLUTIONS) && engine->find_first(grid,
+                solution).count > 0;
+
+        int rating = 0;
+        if (flags & ARCHIVE_RATINGS) {
+            const char *p = line;
+            for (int cells = 0; p != line_end && cells < 81; ++p) {
+                if (!isspace((unsigned char) *p))
+                    ++cells;
+            }
+            rating = atoi(std::string(p, line_end).c_str());
+        }
+
+        writer.add(grid, solved ? &solution : 0, rating);
+        ++count;
+    }
+
+    if (!writer.close()) {
+        std::cerr << "cannot write file " << filename << std::endl;
+        return 1;
+    }
+    std::cout << count << " puzzles written to " << filename << std::endl;
+    return 0;
+}
+
+void usage() {
+    std::cerr << "usage: dancinglinks [-e dlx|bitboard] [--threads N]"
+            " [--mode first|count|unique] [--limit N]"
+            " [--search-threads N] [--max-nodes N] [--max-seconds S]"
+            " [--cache file] [file]"
+            << std::endl;
+    std::cerr << "       dancinglinks [-e dlx|bitboard] --convert archive"
+            " [--solutions] [--ratings] [file]" << std::endl;
 }
 
 int main(int argc, char *argv[]) {
     std::string filename("top1465.txt");
+    BatchOptions options;
+    options.engine_type = ENGINE_DLX;
+    options.mode = MODE_FIRST;
+    options.limit = 0;
+    options.search_threads = 1;
+    options.max_nodes = 0;
+    options.max_seconds = 0;
+    options.cache = 0;
+    std::string cache_name;
+    int num_threads = 0;
+    bool batch = false;
+    std::string archive_name;
+    int archive_flags = 0;
 
-    if (argc > 1) {
-        filename = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "-e" && i + 1 < argc) {
+            std::string name(argv[++i]);
+            if (name == "dlx") {
+                options.engine_type = ENGINE_DLX;
+            } else if (name == "bitboard") {
+                options.engine_type = ENGINE_BITBOARD;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            batch = true;
+            if (num_threads < 1) {
+                usage();
+                return 1;
+            }
+        } else if (arg == "--mode" && i + 1 < argc) {
+            std::string name(argv[++i]);
+            batch = true;
+            if (name == "first") {
+                options.mode = MODE_FIRST;
+            } else if (name == "count") {
+                options.mode = MODE_COUNT;
+            } else if (name == "unique") {
+                options.mode = MODE_UNIQUE;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (arg == "--limit" && i + 1 < argc) {
+            options.limit = atoi(argv[++i]);
+        } else if (arg == "--search-threads" && i + 1 < argc) {
+            options.search_threads = atoi(argv[++i]);
+            batch = true;
+            if (options.search_threads < 1) {
+                usage();
+                return 1;
+            }
+        } else if (arg == "--max-nodes" && i + 1 < argc) {
+            options.max_nodes = atol(argv[++i]);
+            batch = true;
+        } else if (arg == "--max-seconds" && i + 1 < argc) {
+            options.max_seconds = atof(argv[++i]);
+            batch = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cache_name = argv[++i];
+            batch = true;
+        } else if (arg == "--convert" && i + 1 < argc) {
+            archive_name = argv[++i];
+        } else if (arg == "--solutions") {
+            archive_flags |= ARCHIVE_SOLUTIONS;
+        } else if (arg == "--ratings") {
+            archive_flags |= ARCHIVE_RATINGS;
+        } else {
+            filename = arg;
+        }
+    }
+
+    /*
+     * only the dlx engine splits a single search, and only when it counts.
+     */
+    if (options.search_threads > 1 && (options.engine_type != ENGINE_DLX
+            || options.mode == MODE_FIRST)) {
+        std::cerr << "--search-threads needs the dlx engine and --mode count"
+                " or unique" << std::endl;
+        return 1;
     }
 
-    std::ifstream in(filename.c_str());
-    if (!in) {
+    PuzzleSource source;
+    if (!source.open(filename)) {
         std::cerr << "cannot open file " << filename << std::endl;
         return 1;
     }
-    std::string line;
-    while (getline(in, line)) {
-        solve(line);
+
+    if (!archive_name.empty())
+        return convert(source, archive_name, archive_flags,
+                options.engine_type);
+
+    std::unique_ptr<PuzzleArchiveReader> archive;
+    if (PuzzleArchiveReader::is_archive(source)) {
+        archive.reset(new PuzzleArchiveReader());
+        if (!archive->open(filename)) {
+            std::cerr << "invalid archive " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    if (batch) {
+        /*
+         * a missing cache file is created at the end of the run.
+         */
+        std::unique_ptr<SolutionCache> cache;
+        if (!cache_name.empty()) {
+            cache.reset(new SolutionCache());
+            cache->load(cache_name);
+            options.cache = cache.get();
+        }
+        int result = solve_batch(source, archive.get(), num_threads > 0
+                ? num_threads : 1, options);
+        if (cache.get() && !cache->save(cache_name)) {
+            std::cerr << "cannot write file " << cache_name << std::endl;
+            return 1;
+        }
+        return result;
+    }
+
+    /*
+     * the dlx solver reports every solution, the other engines only
+     * the first one.
+     */
+    std::unique_ptr<MySolutionListener> listener(new MySolutionListener());
+    DlxSudokuSolver dlx_solver(listener.get());
+    std::unique_ptr<SolverEngine> engine;
+    if (options.engine_type != ENGINE_DLX)
+        engine.reset(create_solver_engine(options.engine_type));
+
+    if (archive.get()) {
+        char puzzle[81];
+        size_t offset = 0;
+        for (int i = 0; i < archive->get_count(); ++i) {
+            if ((i == 0 && !archive->get_offset(i, offset))
+                    || !archive->read(offset, puzzle)) {
+                std::cerr << "record " << i << " invalid" << std::endl;
+                return 1;
+            }
+            solve(puzzle, puzzle + 81, dlx_solver, engine.get());
+        }
+        return 0;
+    }
+
+    PuzzleReader reader(source, 0, source.get_size());
+    const char *line;
+    const char *line_end;
+    while (reader.next(line, line_end)) {
+        solve(line, line_end, dlx_solver, engine.get());
     }
     return 0;
 }
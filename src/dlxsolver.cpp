@@ -31,74 +31,146 @@
  */
 
 #include <vector>
-#include <iostream>
-#include <sstream>
 #include <cassert>
-#include <fstream>
 #include "dlxsolver.hpp"
+#include "parallelsolver.hpp"
 #include "grid.hpp"
 
 DlxSudokuSolver::DlxSudokuSolver(SolutionListener *solution_listener) :
-    solution_listener(solution_listener) {
+    solution_listener(solution_listener), node_factory(),
+            solver(&node_factory, solution_listener), num_threads(1) {
+    init_matrix();
 }
 
 DlxSudokuSolver::~DlxSudokuSolver() {
 
 }
 
-void DlxSudokuSolver::solve(Grid &grid) {
-    NodeFactory node_factory;
-    Solver solver(&node_factory, solution_listener);
-    init_solver(node_factory, solver, grid);
-    solver.solve();
+void DlxSudokuSolver::solve(const Grid &grid) {
+    if (apply_grid(grid)) {
+        if (num_threads > 1) {
+            ParallelSolver parallel_solver(num_threads);
+            parallel_solver.solve(node_factory, solver, solution_listener);
+        } else {
+            solver.solve();
+        }
+    }
+    solver.reset();
+}
+
+SolutionCount DlxSudokuSolver::count_solutions(const Grid &grid, int limit,
+        long max_nodes, double max_seconds) {
+    SolutionCount count = { 0, false, false };
+
+    if (apply_grid(grid)) {
+        if (num_threads > 1) {
+            ParallelSolver parallel_solver(num_threads);
+            count = parallel_solver.count_solutions(node_factory, solver,
+                    limit, max_nodes, max_seconds);
+        } else {
+            solver.start(limit, false);
+            solver.run(max_nodes, max_seconds);
+            count = solver.get_count();
+        }
+    }
+    solver.reset();
+    return count;
 }
 
-void DlxSudokuSolver::init_solver(NodeFactory &node_factory, Solver &solver,
-        Grid &grid) {
+SolutionCount DlxSudokuSolver::find_first(const Grid &grid, Grid &solution,
+        long max_nodes, double max_seconds) {
+    SolutionCount count = { 0, false, false };
+
+    if (apply_grid(grid)) {
+        solver.start(1, false);
+        solver.run(max_nodes, max_seconds);
+        count = solver.get_count();
+    }
+    solver.reset();
+    if (count.count == 0)
+        return count;
+
+    const std::vector<int> &rows = solver.get_first_solution();
+    for (std::vector<int>::const_iterator i = rows.begin(); i != rows.end(); ++i) {
+        int idx = *i / 9;
+        int value = *i % 9 + 1;
+        Cell &cell = solution[idx];
+        solution.set_cell_value(cell, value);
+        solution.clear_choices(cell);
+    }
+    return count;
+}
+
+bool DlxSudokuSolver::is_unique(const Grid &grid) {
+    return count_solutions(grid, 2).count == 1;
+}
+
+void DlxSudokuSolver::init_matrix() {
     /*
      * ncolumns: all cells + each row/col/block * each possible value (9)
      */
     const int ncolumns = 81 + 3 * 81;
-    std::vector<Column *> columns;
+    std::vector<int> columns;
 
+    node_factory.reserve(1 + ncolumns + 4 * 729);
     for (int i = 0; i < ncolumns; ++i) {
         columns.push_back(solver.add_column(i));
     }
 
+    for (int idx = 0; idx < 81; ++idx) {
+        for (int value = 1; value < 10; ++value) {
+            rows[9 * idx + value - 1] = add_nodes(idx, value, columns);
+        }
+    }
+}
+
+bool DlxSudokuSolver::apply_grid(const Grid &grid) {
+    /*
+     * rows are removed before any clue is selected, so that
+     * Solver::reset() can restore them in reverse order.
+     */
     for (int idx = 0; idx < 81; ++idx) {
         const Cell &cell = grid[idx];
-        if (cell.has_value()) {
-            add_nodes(cell, cell.get_value(), columns, node_factory);
-        } else {
+        if (!cell.has_value()) {
+            const Choices &choices = cell.get_choices();
             for (int value = 1; value < 10; ++value) {
-                if (cell.has_choice(value)) {
-                    add_nodes(cell, value, columns, node_factory);
-                }
+                if (!choices.has_choice(value))
+                    solver.remove_row(rows[9 * idx + value - 1]);
             }
         }
     }
+
+    for (int idx = 0; idx < 81; ++idx) {
+        const Cell &cell = grid[idx];
+        if (cell.has_value()) {
+            if (!solver.select_row(rows[9 * idx + cell.get_value() - 1]))
+                return false;
+        }
+    }
+
+    return true;
 }
 
-void DlxSudokuSolver::add_nodes(const Cell &cell, int value, std::vector<
-        Column *> &columns, NodeFactory &node_factory) {
-    int row = cell.get_row();
-    int col = cell.get_col();
+int DlxSudokuSolver::add_nodes(int idx, int value,
+        const std::vector<int> &columns) {
+    int row = idx / 9;
+    int col = idx % 9;
     int row_idx = 81 * row + 9 * col + value - 1;
     assert(row_idx >= 0 && row_idx < 729);
 
-    int col_idx = cell.get_idx();
+    int col_idx = idx;
     assert(col_idx >= 0 && col_idx < 381);
-    Node *pfirst = node_factory.create_child(columns[col_idx], row_idx);
+    int first = node_factory.create_child(columns[col_idx], row_idx);
 
     col_idx = 81 + row * 9 + value - 1;
     assert(col_idx >= 0 && col_idx < 381);
-    Node *node = node_factory.create_child(columns[col_idx], row_idx);
-    pfirst->add_sibling(node);
+    int node = node_factory.create_child(columns[col_idx], row_idx);
+    node_factory.add_sibling(first, node);
 
     col_idx = 2 * 81 + col * 9 + value - 1;
     assert(col_idx >= 0 && col_idx < 381);
     node = node_factory.create_child(columns[col_idx], row_idx);
-    pfirst->add_sibling(node);
+    node_factory.add_sibling(first, node);
 
     /**
      * block_idx = 0..8
@@ -108,6 +180,7 @@ void DlxSudokuSolver::add_nodes(const Cell &cell, int value, std::vector<
     col_idx = 3 * 81 + block_idx * 9 + value - 1;
     assert(col_idx >= 0 && col_idx < 381);
     node = node_factory.create_child(columns[col_idx], row_idx);
-    pfirst->add_sibling(node);
-}
+    node_factory.add_sibling(first, node);
 
+    return first;
+}
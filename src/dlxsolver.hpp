@@ -34,25 +34,58 @@
 #define DLXSOLVER_HPP
 
 #include "dancinglinks.hpp"
+#include "solverengine.hpp"
 
 class Grid;
-class Cell;
 
-class DlxSudokuSolver {
+/**
+ * Solves sudokus with dancing links. The 729x324 exact cover matrix is
+ * built once in the constructor. Each grid is applied by selecting the rows
+ * of its clues and removing the rows of the eliminated candidates; the
+ * matrix is restored afterwards.
+ *
+ * With more than one thread, solve() and count_solutions() run on a
+ * ParallelSolver; the solution listener is then called from the worker
+ * threads, one solution at a time.
+ */
+class DlxSudokuSolver: public SolverEngine {
 private:
     SolutionListener *solution_listener;
+    NodeFactory node_factory;
+    Solver solver;
+    int num_threads;
+    /*! \brief first node of each of the 729 rows */
+    int rows[729];
 public:
-    DlxSudokuSolver(SolutionListener *solution_listener);
+    DlxSudokuSolver(SolutionListener *solution_listener = 0);
     virtual ~DlxSudokuSolver();
-    void solve(Grid &grid);
+    void set_num_threads(int num_threads);
+    int get_num_threads() const;
+    /*! \brief reports all solutions to the solution listener */
+    void solve(const Grid &grid);
+    SolutionCount count_solutions(const Grid &grid, int limit,
+            long max_nodes = 0, double max_seconds = 0);
+    SolutionCount find_first(const Grid &grid, Grid &solution,
+            long max_nodes = 0, double max_seconds = 0);
+    bool is_unique(const Grid &grid);
 private:
-    void init_solver(NodeFactory &node_factory, Solver &solver, Grid &grid);
-    void add_nodes(const Cell &cell, int value, std::vector<Column *> &columns,
-            NodeFactory &node_factory);
-    DlxSudokuSolver(const DlxSudokuSolver &other) {
+    void init_matrix();
+    bool apply_grid(const Grid &grid);
+    int add_nodes(int idx, int value, const std::vector<int> &columns);
+    DlxSudokuSolver(const DlxSudokuSolver &other) :
+        node_factory(), solver(&node_factory, 0) {
     }
     DlxSudokuSolver &operator =(const DlxSudokuSolver &other) {
         return *this;
     }
 };
+
+inline void DlxSudokuSolver::set_num_threads(int num_threads) {
+    this->num_threads = num_threads;
+}
+
+inline int DlxSudokuSolver::get_num_threads() const {
+    return num_threads;
+}
+
 #endif
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <queue>
 #include <stack>
+#include <new>
 #include "grid.hpp"
 #include "hintconsumer.hpp"
 #include "forcingchain.hpp"
@@ -49,14 +50,27 @@
 #include "xwing.hpp"
 #include "xywing.hpp"
 
+/*!
+ * \brief allocates the links of a search in blocks.
+ *
+ * links own no memory, so reset releases all links at once. the blocks are
+ * kept for the next search.
+ */
 class LinkFactory {
-    std::vector<Link *> links;
+    enum {
+        BLOCK_SIZE = 4096
+    };
+    std::vector<void *> blocks;
+    size_t block;
+    size_t used;
 public:
     LinkFactory();
-    virtual ~LinkFactory();
-    StrongLink *create_strong_link(Link *parent, int cell_idx, int value);
-    WeakLink *create_weak_link(Link *parent, int cell_idx, int value);
+    ~LinkFactory();
+    Link *create_strong_link(Link *parent, int cell_idx, int value);
+    Link *create_weak_link(Link *parent, int cell_idx, int value);
+    void reset();
 private:
+    void *allocate();
     LinkFactory(const LinkFactory &) {
     }
     LinkFactory &operator =(const LinkFactory &) {
@@ -64,25 +78,39 @@ private:
     }
 };
 
-LinkFactory::LinkFactory() {
-
+LinkFactory::LinkFactory() :
+    block(0), used(BLOCK_SIZE) {
 }
 
 LinkFactory::~LinkFactory() {
-    std::for_each(links.begin(), links.end(), destroy<Link *> ());
+    for (std::vector<void *>::iterator i = blocks.begin(); i != blocks.end(); ++i)
+        ::operator delete(*i);
 }
 
-StrongLink *LinkFactory::create_strong_link(Link *parent, int cell_idx,
-        int value) {
-    StrongLink *link = new StrongLink(parent, cell_idx, value);
-    links.push_back(link);
-    return link;
+void LinkFactory::reset() {
+    block = 0;
+    used = blocks.empty() ? BLOCK_SIZE : 0;
 }
 
-WeakLink *LinkFactory::create_weak_link(Link *parent, int cell_idx, int value) {
-    WeakLink *link = new WeakLink(parent, cell_idx, value);
-    links.push_back(link);
-    return link;
+inline void *LinkFactory::allocate() {
+    if (used == BLOCK_SIZE) {
+        if (!blocks.empty() && block + 1 < blocks.size()) {
+            ++block;
+        } else {
+            blocks.push_back(::operator new(BLOCK_SIZE * sizeof(Link)));
+            block = blocks.size() - 1;
+        }
+        used = 0;
+    }
+    return static_cast<char *> (blocks[block]) + sizeof(Link) * used++;
+}
+
+Link *LinkFactory::create_strong_link(Link *parent, int cell_idx, int value) {
+    return new (allocate()) Link(parent, cell_idx, value, true);
+}
+
+Link *LinkFactory::create_weak_link(Link *parent, int cell_idx, int value) {
+    return new (allocate()) Link(parent, cell_idx, value, false);
 }
 
 /*!
@@ -163,6 +191,14 @@ ForcingChainHint::ForcingChainHint(const std::vector<Link *> &links) :
     }
 }
 
+/*
+ * a conclusion still changes the grid, if the value can be set or removed.
+ */
+static bool is_open_conclusion(const Grid &grid, int cell_idx, int value) {
+    const Cell &cell = grid[cell_idx];
+    return !cell.has_value() && cell.has_choice(value);
+}
+
 /*!
  * \brief destructor
  */
@@ -175,13 +211,19 @@ void ForcingChainHint::apply(Grid &grid) {
     Cell &cell = grid[link_entry.get_cell_idx()];
 
     if (link_entry.is_strong()) {
-        cell.set_value(link_entry.get_value());
+        grid.set_cell_value(cell, link_entry.get_value());
         grid.cleanup_choice(cell);
     } else {
-        cell.remove_choice(link_entry.get_value());
+        grid.remove_choice(cell, link_entry.get_value());
     }
 }
 
+bool ForcingChainHint::is_applicable(const Grid &grid) const {
+    const LinkEntry &link_entry = chains.front().back();
+    return is_open_conclusion(grid, link_entry.get_cell_idx(),
+            link_entry.get_value());
+}
+
 void ForcingChainHint::print_description(std::ostream &out) const {
     out << "forcing chain: conclusion: " << print_link_entry(
             chains.front().back());
@@ -210,13 +252,18 @@ void ForcingChainRangeHint::apply(Grid &grid) {
     Cell &cell = grid[link.get_cell_idx()];
 
     if (link.is_strong()) {
-        cell.set_value(link.get_value());
+        grid.set_cell_value(cell, link.get_value());
         grid.cleanup_choice(cell);
     } else {
-        cell.remove_choice(link.get_value());
+        grid.remove_choice(cell, link.get_value());
     }
 }
 
+bool ForcingChainRangeHint::is_applicable(const Grid &grid) const {
+    const LinkEntry &link = chains.front().back();
+    return is_open_conclusion(grid, link.get_cell_idx(), link.get_value());
+}
+
 void ForcingChainRangeHint::print_description(std::ostream &out) const {
     out << "range forcing chain: range: " << range.get_name()
             << " conclusion: " << print_link_entry(chains.front().back());
@@ -245,13 +292,18 @@ void ForcingChainContradictionHint::apply(Grid &grid) {
     LinkEntry &link = first_chain.front();
     Cell &cell = grid[link.get_cell_idx()];
     if (link.is_strong()) {
-        cell.remove_choice(link.get_value());
+        grid.remove_choice(cell, link.get_value());
     } else {
-        cell.set_value(link.get_value());
+        grid.set_cell_value(cell, link.get_value());
         grid.cleanup_choice(cell);
     }
 }
 
+bool ForcingChainContradictionHint::is_applicable(const Grid &grid) const {
+    const LinkEntry &link = first_chain.front();
+    return is_open_conclusion(grid, link.get_cell_idx(), link.get_value());
+}
+
 void ForcingChainContradictionHint::print_description(std::ostream &out) const {
     const LinkEntry &link = first_chain.front();
     if (link.is_strong()) {
@@ -269,40 +321,6 @@ const char *ForcingChainContradictionHint::get_name() const {
     return "Forcing chain contradiction";
 }
 
-Link::Link(Link *parent, int cell_idx, int value) :
-    parent(parent), cell_idx(cell_idx), value(value) {
-    if (parent)
-        parent->children.push_back(this);
-}
-
-Link::~Link() {
-
-}
-
-const Link *Link::get_parent() const {
-    return parent;
-}
-
-Link *Link::get_parent() {
-    return parent;
-}
-
-int Link::get_cell_idx() const {
-    return cell_idx;
-}
-
-int Link::get_value() const {
-    return value;
-}
-
-Link::const_iterator Link::begin() const {
-    return children.begin();
-}
-
-Link::const_iterator Link::end() const {
-    return children.end();
-}
-
 Link *Link::get_head() {
     Link *p = this;
     while (p->get_parent() != 0) {
@@ -311,208 +329,170 @@ Link *Link::get_head() {
     return p;
 }
 
-StrongLink::StrongLink(Link *parent, int cell_idx, int value) :
-    Link(parent, cell_idx, value) {
-}
-
-bool StrongLink::is_strong_link() const {
-    return true;
-}
-
-WeakLink::WeakLink(Link *parent, int cell_idx, int value) :
-    Link(parent, cell_idx, value) {
-}
-
-bool WeakLink::is_strong_link() const {
-    return false;
-}
-
 LinkMap::LinkMap() :
-    weak_links(81), strong_links(81) {
+    count(0) {
 }
 
-Link *LinkMap::find_contradiction(const Link *link) {
-    if (link->is_strong_link())
-        return find_strong_contradiction(link);
-    else
-        return find_weak_contradiction(link);
-}
-
-Link *LinkMap::find_strong_contradiction(const Link *link) {
-    for (std::vector<Link *>::iterator i =
-            strong_links[link->get_cell_idx()].begin(); i
-            != strong_links[link->get_cell_idx()].end(); ++i) {
-        if ((*i)->get_value() != link->get_value())
-            return *i;
-    }
-
-    for (std::vector<Link *>::iterator i =
-            weak_links[link->get_cell_idx()].begin(); i
-            != weak_links[link->get_cell_idx()].end(); ++i) {
-        if ((*i)->get_value() == link->get_value())
-            return *i;
+Link *LinkMap::find_first(Link * const *links, const unsigned *order,
+        int cell_idx, unsigned values) const {
+    int best = -1;
+    for (; values != 0; values &= values - 1) {
+        int candidate = cell_idx * 9 + first_bit(values);
+        if (best < 0 || order[candidate] < order[best])
+            best = candidate;
     }
-
-    return 0;
+    return links[best];
 }
 
-Link *LinkMap::find_weak_contradiction(const Link *link) {
-    std::vector<Link *> &links = strong_links[link->get_cell_idx()];
+Link *LinkMap::find_contradiction(const Link *link) const {
+    int cell_idx = link->get_cell_idx();
+    int value = link->get_value();
 
-    for (std::vector<Link *>::iterator i = links.begin(); i != links.end(); ++i) {
-        if ((*i)->get_value() == link->get_value())
-            return *i;
+    if (link->is_strong_link()) {
+        unsigned others = strong_set.get_values(cell_idx) & ~(1u << (value
+                - 1));
+        if (others != 0)
+            return find_first(strong_links, strong_order, cell_idx, others);
+        if (weak_set.test(cell_idx, value))
+            return get_weak_link(cell_idx, value);
+    } else {
+        if (strong_set.test(cell_idx, value))
+            return get_strong_link(cell_idx, value);
     }
-
     return 0;
 }
 
-inline bool insert_into(std::vector<std::vector<Link *> > &linkmap, Link *link) {
-    std::vector<Link *> &links = linkmap[link->get_cell_idx()];
+bool LinkMap::insert(Link *link) {
+    int cell_idx = link->get_cell_idx();
+    int value = link->get_value();
+    int candidate = cell_idx * 9 + value - 1;
 
-    for (std::vector<Link *>::iterator i = links.begin(); i != links.end(); ++i) {
-        if ((*i)->get_value() == link->get_value())
+    if (link->is_strong_link()) {
+        if (strong_set.test(cell_idx, value))
+            return false;
+        strong_set.set(cell_idx, value);
+        strong_links[candidate] = link;
+        strong_order[candidate] = count++;
+    } else {
+        if (weak_set.test(cell_idx, value))
             return false;
+        weak_set.set(cell_idx, value);
+        weak_links[candidate] = link;
+        weak_order[candidate] = count++;
     }
-    links.push_back(link);
     return true;
 }
 
-bool LinkMap::insert(Link *link) {
-    if (link->is_strong_link()) {
-        return insert_into(strong_links, link);
-    } else {
-        return insert_into(weak_links, link);
+bool LinkMap::find_conclusion(const LinkMap &link_map,
+        std::vector<Link *> &links_found) const {
+    CandidateSet common(strong_set);
+    common &= link_map.strong_set;
+    int cell_idx = common.get_cells().first();
+    if (cell_idx >= 0) {
+        Link *link = find_first(strong_links, strong_order, cell_idx,
+                common.get_values(cell_idx));
+        links_found.push_back(link);
+        links_found.push_back(link_map.get_strong_link(cell_idx,
+                link->get_value()));
+        return true;
     }
-}
 
-void LinkMap::insert_all(LinkMap &other) {
-    for (int i = 0; i < 81; ++i) {
-        std::copy(other.strong_links[i].begin(), other.strong_links[i].end(),
-                std::back_inserter(strong_links[i]));
+    common = weak_set;
+    common &= link_map.weak_set;
+    cell_idx = common.get_cells().first();
+    if (cell_idx >= 0) {
+        Link *link = find_first(weak_links, weak_order, cell_idx,
+                common.get_values(cell_idx));
+        links_found.push_back(link);
+        links_found.push_back(link_map.get_weak_link(cell_idx,
+                link->get_value()));
+        return true;
     }
 
-    for (int i = 0; i < 81; ++i) {
-        std::copy(other.weak_links[i].begin(), other.weak_links[i].end(),
-                std::back_inserter(weak_links[i]));
-    }
+    return false;
 }
 
-bool LinkMap::find_common_conclusion(size_t size,
-        std::vector<Link *> &conclusions) {
-    if (size == 0) {
-        return false;
-    }
-
-    for (int i = 0; i < 81; ++i) {
-        if (strong_links[i].size() == size && all_values_equal(strong_links[i])) {
-            std::copy(strong_links[i].begin(), strong_links[i].end(),
-                    std::back_inserter(conclusions));
-            return true;
-        }
+void LinkMap::insert_unique_children(Link *link) {
+    std::queue<Link *> q;
+    insert(link);
+    for (Link *c = link->get_first_child(); c != 0; c = c->get_next_sibling()) {
+        q.push(c);
     }
-    for (int i = 0; i < 81; ++i) {
-        size_t frequencies[10];
-        std::vector<Link *> &links = weak_links[i];
-        build_frequencies(links, frequencies);
-        for (int value = 1; value < 10; ++value) {
-            if (frequencies[value] == size) {
-                for (std::vector<Link *>::iterator j = links.begin(); j
-                        != links.end(); ++j) {
-                    if ((*j)->get_value() == value) {
-                        conclusions.push_back(*j);
-                    }
-                }
-                return true;
-            }
+    while (!q.empty()) {
+        Link *l = q.front();
+        q.pop();
+        insert(l);
+        for (Link *c = l->get_first_child(); c != 0; c = c->get_next_sibling()) {
+            q.push(c);
         }
     }
-    return false;
 }
 
-void LinkMap::build_frequencies(const std::vector<Link *> &links,
-        size_t frequencies[10]) const {
-
-    std::fill(frequencies, frequencies + 10, 0);
-    for (std::vector<Link *>::const_iterator i = links.begin(); i
-            != links.end(); ++i) {
-        ++frequencies[(*i)->get_value()];
-    }
+ConclusionMap::ConclusionMap() :
+    branches(0) {
 }
 
-bool LinkMap::all_values_equal(const std::vector<Link *> &v) const {
-    if (v.empty())
-        return false;
-
-    int value = v.front()->get_value();
-    for (std::vector<Link *>::const_iterator i = v.begin() + 1; i != v.end(); ++i) {
-        if ((*i)->get_value() != value)
-            return false;
+void ConclusionMap::insert_all(const LinkMap &link_map) {
+    if (branches == 0) {
+        strong_all = link_map.get_strong_set();
+        weak_all = link_map.get_weak_set();
+    } else {
+        strong_all &= link_map.get_strong_set();
+        weak_all &= link_map.get_weak_set();
     }
-    return true;
-}
+    strong_any |= link_map.get_strong_set();
+    ++branches;
 
-inline Link *LinkMap::find_weak_link(const Link *link) {
-    std::vector<Link *> &links = weak_links[link->get_cell_idx()];
-    for (std::vector<Link *>::iterator j = links.begin(); j != links.end(); ++j) {
-        if ((*j)->get_value() == link->get_value())
-            return *j;
+    /*
+     * the intersection only shrinks, so the links of the candidates which
+     * already dropped out are never needed.
+     */
+    for (int value = 1; value < 10; ++value) {
+        const Bitboard &strong = strong_all.get_cells(value);
+        for (int idx = strong.first(); idx != -1; idx = strong.next(idx)) {
+            Entry entry = { static_cast<short> (idx * 9 + value - 1), true,
+                    link_map.get_strong_link(idx, value) };
+            entries.push_back(entry);
+        }
+        const Bitboard &weak = weak_all.get_cells(value);
+        for (int idx = weak.first(); idx != -1; idx = weak.next(idx)) {
+            Entry entry = { static_cast<short> (idx * 9 + value - 1), false,
+                    link_map.get_weak_link(idx, value) };
+            entries.push_back(entry);
+        }
     }
-    return 0;
 }
 
-inline Link *LinkMap::find_strong_link(const Link *link) {
-    std::vector<Link *> &links = strong_links[link->get_cell_idx()];
-    for (std::vector<Link *>::iterator j = links.begin(); j != links.end(); ++j) {
-        if ((*j)->get_value() == link->get_value())
-            return *j;
+void ConclusionMap::collect(bool strong, int candidate,
+        std::vector<Link *> &conclusions) const {
+    for (std::vector<Entry>::const_iterator i = entries.begin(); i
+            != entries.end(); ++i) {
+        if (i->strong == strong && i->candidate == candidate)
+            conclusions.push_back(i->link);
     }
-    return 0;
 }
 
-bool LinkMap::find_conclusion(LinkMap &link_map,
-        std::vector<Link *> &links_found) {
-    for (int i = 0; i < 81; ++i) {
-        std::vector<Link *> &links = strong_links[i];
-        for (std::vector<Link *>::iterator j = links.begin(); j != links.end(); ++j) {
-            Link *link = link_map.find_strong_link(*j);
-            if (link != 0) {
-                links_found.push_back(*j);
-                links_found.push_back(link);
-                return true;
-            }
-        }
-    }
+bool ConclusionMap::find_common_conclusion(std::vector<Link *> &conclusions) const {
+    if (branches == 0)
+        return false;
 
-    for (int i = 0; i < 81; ++i) {
-        std::vector<Link *> &links = weak_links[i];
-        for (std::vector<Link *>::iterator j = links.begin(); j != links.end(); ++j) {
-            Link *link = link_map.find_weak_link(*j);
-            if (link != 0) {
-                links_found.push_back(*j);
-                links_found.push_back(link);
-                return true;
-            }
+    Bitboard cells = strong_all.get_cells();
+    for (int idx = cells.first(); idx != -1; idx = cells.next(idx)) {
+        unsigned values = strong_any.get_values(idx);
+        if (count_bits(values) == 1) {
+            collect(true, idx * 9 + first_bit(values), conclusions);
+            return true;
         }
     }
 
-    return false;
-}
-
-void LinkMap::insert_unique_children(Link *link) {
-    std::queue<Link *> q;
-    insert(link);
-    for (Link::const_iterator i = link->begin(); i != link->end(); ++i) {
-        q.push(*i);
-    }
-    while (!q.empty()) {
-        Link *l = q.front();
-        q.pop();
-        insert(l);
-        for (Link::const_iterator i = l->begin(); i != l->end(); ++i) {
-            q.push(*i);
-        }
+    cells = weak_all.get_cells();
+    int idx = cells.first();
+    if (idx >= 0) {
+        collect(false, idx * 9 + first_bit(weak_all.get_values(idx)),
+                conclusions);
+        return true;
     }
+    return false;
 }
 
 struct QueueStrategy {
@@ -534,9 +514,11 @@ struct QueueStrategy {
 };
 
 void ForcingChainHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
+    LinkFactory factory;
+
     for (int value = 1; value < 10; ++value) {
         std::vector<Link *> queue_links;
-        LinkFactory factory;
+        factory.reset();
 
         find_forcing_chain<QueueStrategy> (value, grid, consumer, queue_links,
                 factory, 0);
@@ -565,7 +547,7 @@ void ForcingChainHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
         for (std::vector<HintProducer *>::iterator i = hint_producers.begin(); i
                 != hint_producers.end(); ++i) {
             std::vector<Link *> queue_links;
-            LinkFactory factory;
+            factory.reset();
 
             find_forcing_chain<QueueStrategy> (value, grid, consumer,
                     queue_links, factory, *i);
@@ -596,8 +578,7 @@ void ForcingChainHintProducer::analyze_links(std::vector<Link *> &links,
     for (RangeList::const_iterator irange = RANGES.begin(); irange
             != RANGES.end(); ++irange) {
         const Range &range = *irange;
-        LinkMap all_links;
-        size_t count = 0;
+        ConclusionMap all_links;
 
         for (Range::const_iterator i = range.begin(); i != range.end(); ++i) {
             std::vector<Link *> &range_links = cell_links[*i];
@@ -606,13 +587,12 @@ void ForcingChainHintProducer::analyze_links(std::vector<Link *> &links,
                 Link *l = *j;
                 LinkMap link_map;
                 link_map.insert_unique_children(l);
-                ++count;
                 all_links.insert_all(link_map);
             }
         }
 
         std::vector<Link *> conclusions;
-        if (all_links.find_common_conclusion(count, conclusions)) {
+        if (all_links.find_common_conclusion(conclusions)) {
             ForcingChainRangeHint *hint = new ForcingChainRangeHint(range,
                     conclusions);
             if (!consumer.consume_hint(hint))
@@ -632,32 +612,38 @@ template<class Strategy>
 void ForcingChainHintProducer::find_forcing_chain(int value, Grid &grid,
         HintConsumer &consumer, std::vector<Link *> &links,
         LinkFactory &factory, HintProducer *producer) const {
-    LinkMap allLinks;
-    int link_count = 0;
+    ConclusionMap allLinks;
     std::vector<Link *> local_links;
 
+    /*
+     * the assumptions are tried on a single copy of the grid. after each
+     * try the undo log restores the cells, which have been changed.
+     */
+    Grid trial(grid);
+    std::vector<CellState> undo_log;
+    trial.set_undo_log(&undo_log);
+
     for (Grid::iterator i = grid.begin(); i != grid.end(); ++i) {
         Cell &cell = *i;
         if (cell.has_choice(value)) {
-            ++link_count;
-            Grid weak_backup(grid);
-            WeakLink *weak_link = factory.create_weak_link(0, cell.get_idx(),
+            Link *weak_link = factory.create_weak_link(0, cell.get_idx(),
                     value);
             LinkMap weak_link_map;
 
             if (find_contradiction<Strategy> (weak_link, weak_link_map,
-                    weak_backup, grid, consumer, factory, producer)) {
+                    trial, grid, consumer, factory, producer)) {
                 return;
             }
+            trial.undo(0);
 
-            StrongLink *strong_link = factory.create_strong_link(0,
+            Link *strong_link = factory.create_strong_link(0,
                     cell.get_idx(), value);
             LinkMap strong_link_map;
-            Grid strong_backup(grid);
             if (find_contradiction<Strategy> (strong_link, strong_link_map,
-                    strong_backup, grid, consumer, factory, producer)) {
+                    trial, grid, consumer, factory, producer)) {
                 return;
             }
+            trial.undo(0);
 
             if (find_conclusion(weak_link, strong_link, weak_link_map,
                     strong_link_map, grid, consumer)) {
@@ -670,7 +656,7 @@ void ForcingChainHintProducer::find_forcing_chain(int value, Grid &grid,
         }
     }
 
-    if (!find_common_conclusion(allLinks, link_count, grid, consumer)) {
+    if (!find_common_conclusion(allLinks, grid, consumer)) {
         std::copy(local_links.begin(), local_links.end(), std::back_inserter(
                 links));
     }
@@ -732,14 +718,14 @@ bool ForcingChainHintProducer::find_contradiction(Link *start,
         if (link->is_strong_link()) {
             find_weak_links(link, links, grid, factory);
             Cell &cell = grid[link->get_cell_idx()];
-            cell.set_value(link->get_value());
-            cell.clear_choices();
+            grid.set_cell_value(cell, link->get_value());
+            grid.clear_choices(cell);
             grid.cleanup_choice(cell);
             find_links_in_ranges(link, links, grid, factory);
             find_links_with_one_choice_left(link, links, grid, factory);
         } else {
             Cell &cell = grid[link->get_cell_idx()];
-            cell.remove_choice(link->get_value());
+            grid.remove_choice(cell, link->get_value());
             find_strong_links(link, links, grid, factory);
         }
 
@@ -764,12 +750,10 @@ bool ForcingChainHintProducer::find_contradiction(Link *start,
     return false;
 }
 
-bool ForcingChainHintProducer::find_common_conclusion(LinkMap &allLinks,
-        size_t nconclusions, Grid &grid, HintConsumer &consumer) const {
-    if (nconclusions == 0)
-        return false;
+bool ForcingChainHintProducer::find_common_conclusion(
+        ConclusionMap &allLinks, Grid &grid, HintConsumer &consumer) const {
     std::vector<Link *> conclusions;
-    if (allLinks.find_common_conclusion(nconclusions, conclusions)) {
+    if (allLinks.find_common_conclusion(conclusions)) {
         consumer.consume_hint(new ForcingChainHint(conclusions));
         return true;
     }
@@ -777,10 +761,9 @@ bool ForcingChainHintProducer::find_common_conclusion(LinkMap &allLinks,
 }
 
 inline int get_opposite_value(Cell &cell, int value) {
-    for (int v = 1; v < 10; ++v)
-        if (cell.has_choice(v) && v != value)
-            return v;
-    return 0;
+    Choices choices = cell.get_choices();
+    choices.remove_choice(value);
+    return choices.first_choice();
 }
 
 void ForcingChainHintProducer::find_strong_links(Link *link,
@@ -815,24 +798,21 @@ void ForcingChainHintProducer::fill_range_frequencies(const Range &range,
         Grid &grid, std::vector<std::vector<Cell *> > &frequencies) const {
     for (Range::const_iterator i = range.begin(); i != range.end(); ++i) {
         Cell &cell = grid[*i];
-        for (int value = 1; value < 10; ++value) {
-            if (cell.has_choice(value)) {
-                frequencies[value].push_back(&cell);
-            }
+        const Choices &choices = cell.get_choices();
+        for (int value = choices.first_choice(); value != 0; value
+                = choices.next_choice(value)) {
+            frequencies[value].push_back(&cell);
         }
     }
 }
 
 void ForcingChainHintProducer::find_links_in_ranges(Link *link, std::vector<
         Link *> &links, Grid &grid, LinkFactory &factory) const {
-    const std::vector<Range> &ranges = RANGES.get_field_ranges(
-            link->get_cell_idx());
-
-    for (std::vector<Range>::const_iterator irange = ranges.begin(); irange
-            != ranges.end(); ++irange) {
+    for (int i = 0; i < 3; ++i) {
+        const Range &range = RANGES.get_field_range(link->get_cell_idx(), i);
         std::vector<std::vector<Cell *> > frequencies(10);
 
-        fill_range_frequencies(*irange, grid, frequencies);
+        fill_range_frequencies(range, grid, frequencies);
         for (int value = 1; value < 10; ++value) {
             if (frequencies[value].size() == 1) {
                 Cell *cell = frequencies[value].front();
@@ -851,10 +831,11 @@ void ForcingChainHintProducer::find_weak_links(Link *link,
             RANGES.field_end(link->get_cell_idx());
     Cell &c = grid[link->get_cell_idx()];
 
-    for (int value = 1; value < 10; ++value) {
-        if (value != link->get_value() && c.has_choice(value)) {
-            links.push_back(factory.create_weak_link(link, c.get_idx(), value));
-        }
+    Choices others = c.get_choices();
+    others.remove_choice(link->get_value());
+    for (int value = others.first_choice(); value != 0; value
+            = others.next_choice(value)) {
+        links.push_back(factory.create_weak_link(link, c.get_idx(), value));
     }
 
     for (RangeList::const_index_iterator i = begin; i != end; ++i) {
@@ -877,15 +858,15 @@ public:
 
     bool consume_hint(Hint *hint) {
         IndirectHint *h = dynamic_cast<IndirectHint *> (hint);
-        std::vector<std::pair<int, int> >::const_iterator begin =
-                h->get_choices_to_remove().begin();
-        std::vector<std::pair<int, int> >::const_iterator end =
-                h->get_choices_to_remove().end();
-
-        for (std::vector<std::pair<int, int> >::const_iterator i = begin; i
-                != end; ++i) {
-            links.push_back(factory.create_weak_link(parent,
-                    i->first, i->second));
+        const CandidateSet &choices = h->get_choices_to_remove();
+        Bitboard cells = choices.get_cells();
+
+        for (int idx = cells.first(); idx != -1; idx = cells.next(idx)) {
+            Choices values(choices.get_values(idx));
+            for (int value = values.first_choice(); value != 0; value
+                    = values.next_choice(value)) {
+                links.push_back(factory.create_weak_link(parent, idx, value));
+            }
         }
 
         delete hint;
@@ -35,6 +35,7 @@
 
 #include <vector>
 #include "hint.hpp"
+#include "candidateset.hpp"
 
 class Range;
 class Link;
@@ -75,6 +76,7 @@ public:
      */
     virtual ~ForcingChainHint();
     void apply(Grid &grid);
+    bool is_applicable(const Grid &grid) const;
     void print_description(std::ostream &out) const;
     const char *get_name() const;
 };
@@ -86,6 +88,7 @@ public:
     ForcingChainRangeHint(const Range &range,
             std::vector<Link *> &conclusions);
     void apply(Grid &grid);
+    bool is_applicable(const Grid &grid) const;
     void print_description(std::ostream &out) const;
     const char *get_name() const;
 };
@@ -113,6 +116,7 @@ public:
      */
     virtual ~ForcingChainContradictionHint();
     void apply(Grid &grid);
+    bool is_applicable(const Grid &grid) const;
     void print_description(std::ostream &out) const;
     virtual const char *get_name() const;
 };
@@ -123,36 +127,45 @@ public:
  *  there are two types of links:
  *      * a strong link means: if the parent assumption is true, then the cell must have a certain value.
  *      * a weak link means: if the parent assumption is true, then the cell cannot have a certain value.
+ *
+ *  a search creates hundreds of thousands of links. they are plain objects
+ *  allocated by a LinkFactory, the children are kept as a list of siblings,
+ *  so a link owns no memory and all links of a search are released at once.
  */
 
 class Link {
-public:
-    /*! \brief iterator over the children of a link */
-    typedef std::vector<Link *>::iterator iterator;
-    /*! \brief const_iterator over the children of a link */
-    typedef std::vector<Link *>::const_iterator const_iterator;
-private:
     /*!
      * \brief pointer to the parent assumption (or null,
      * if there is no such assumption)
      */
     Link *parent;
 
+    /*!
+     * \brief the first and the last conclusion which result of this link
+     */
+    Link *first_child;
+    Link *last_child;
+
+    /*!
+     * \brief the next conclusion of the parent assumption
+     */
+    Link *next_sibling;
+
     /*!
      * \brief index of the cell, this link refers to
      */
-    int cell_idx;
+    unsigned char cell_idx;
 
     /*!
      * \brief value which the cell must have (in case of a strong link)
      * or cannot have (in case of a weak link)
      * */
-    int value;
+    unsigned char value;
 
     /*!
-     * \brief the conclusions which result of this link
+     * \brief true for a strong link, false for a weak link
      */
-    std::vector<Link *> children;
+    bool strong;
 public:
     /*!
      * \brief constructor
@@ -160,13 +173,9 @@ public:
      * \param  index of the cell, this link refers to
      * \param value value which the cell must have (in case of a strong link)
      *        or cannot have (in case of a weak link
+     * \param strong true for a strong link, false for a weak link
      */
-    Link(Link *parent, int cell_idx, int value);
-
-    /*!
-     * \brief destructor
-     */
-    virtual ~Link();
+    Link(Link *parent, int cell_idx, int value, bool strong);
 
     /*!
      * \brief returns the parent assumption of this link
@@ -196,16 +205,17 @@ public:
     int get_value() const;
 
     /*!
-     * \brief returns an iterator to the first child of this link
-     * \return iterator to the first child of this link
+     * \brief returns the first child of this link or null, if there is none
+     *
+     * \verbatim
+     for (Link *c = l->get_first_child(); c != 0; c = c->get_next_sibling()) \endverbatim
      */
-    const_iterator begin() const;
+    Link *get_first_child() const;
 
     /*!
-     * \brief returns an iterator past the last child of this link
-     * \return iterator past the last child of this link
+     * \brief returns the next child of the parent or null, if there is none
      */
-    const_iterator end() const;
+    Link *get_next_sibling() const;
 
     /*!
      * \brief returns true, if this link is a strong link and false,
@@ -214,43 +224,36 @@ public:
      * \return  true, if this link is a strong link and false,
      * if this link is a weak link
      */
-    virtual bool is_strong_link() const = 0;
+    bool is_strong_link() const;
 
     Link *get_head();
 private:
-    Link(const Link *other) {
+    Link(const Link &other) {
     }
-    Link &operator =(const Link *other) {
+    Link &operator =(const Link &other) {
         return *this;
     }
 };
 
 /*!
- * \brief a strong link states, that a cell must have a given value if
- * its parent assumption is true.
- */
-class StrongLink: public Link {
-public:
-    StrongLink(Link *parent, int cell_idx, int value);
-    virtual bool is_strong_link() const;
-};
-
-/*!
- * \brief a weak link states, that a cell cannot have a given value if
- * its parent assumption is true.
- */
-class WeakLink: public Link {
-public:
-    WeakLink(Link *parent, int cell_idx, int value);
-    virtual bool is_strong_link() const;
-};
-
-/*!
- * \brief stores links.
+ * \brief stores the links of a single assumption.
+ *
+ * the conclusions are kept as two sets of candidates, one for the strong
+ * and one for the weak links, so contradictions and common conclusions are
+ * found with a few word operations. a side table keeps the first link which
+ * produced each candidate and the order of insertion, the chains are only
+ * built from it when a hint is created.
  */
 class LinkMap {
-    std::vector<std::vector<Link *> > weak_links;
-    std::vector<std::vector<Link *> > strong_links;
+    CandidateSet strong_set;
+    CandidateSet weak_set;
+    /*! \brief the link of each candidate, valid if the bit is set */
+    Link *strong_links[729];
+    Link *weak_links[729];
+    /*! \brief the position of each candidate in the order of insertion */
+    unsigned strong_order[729];
+    unsigned weak_order[729];
+    unsigned count;
 public:
     /*!
      * \brief constructor
@@ -263,29 +266,15 @@ public:
      * \return the link which is a contradiction or null, if no such link
      * has been found
      */
-    Link *find_contradiction(const Link *link);
+    Link *find_contradiction(const Link *link) const;
 
     /*!
      * \brief inserts a link into the map
      * \param link the link to be inserted into the map
+     * \return false, if the map already has a link with the same conclusion
      */
     bool insert(Link *link);
 
-    /*!
-     * \brief inserts a set of links into the map
-     * \param other the links to be inserted
-     */
-    void insert_all(LinkMap &other);
-
-    /*!
-     *  \brief finds a list of common conclusions
-     *  \param size the number of links that have to be found,
-     *  to have a common conclusion
-     *  \param the conclusion found
-     *  \return true, if a conclusion has been found
-     */
-    bool find_common_conclusion(size_t size, std::vector<Link *> &conclusions);
-
     /*!
      * \brief
      *  checks all links strored in this map, if there is a matching link in the
@@ -295,43 +284,80 @@ public:
      *  \param link_map the other link map
      *  \return a vector either containing the two matching links or an empty vector.
      */
-    bool find_conclusion(LinkMap &link_map, std::vector<Link *> &links_found);
+    bool find_conclusion(const LinkMap &link_map,
+            std::vector<Link *> &links_found) const;
 
     void insert_unique_children(Link *link);
+
+    const CandidateSet &get_strong_set() const;
+    const CandidateSet &get_weak_set() const;
+    /*! \brief returns the link of a candidate contained in the strong set */
+    Link *get_strong_link(int cell_idx, int value) const;
+    /*! \brief returns the link of a candidate contained in the weak set */
+    Link *get_weak_link(int cell_idx, int value) const;
 private:
     LinkMap(const LinkMap &other) {
     }
     LinkMap &operator =(const LinkMap &other) {
         return *this;
     }
-    Link *find_strong_contradiction(const Link *link);
-    Link *find_weak_contradiction(const Link *link);
     /*!
-     * \brief returns true, if all values in a given list are equal
-     * \param v the list of links
-     * \return true all links have equal values
+     * \brief returns the link inserted first among the given values of a cell
+     * \param links the side table of the links
+     * \param order the side table of the insertion order
+     * \param values the values (bit value - 1) to choose from, not empty
      */
-    bool all_values_equal(const std::vector<Link *> &v) const;
+    Link *find_first(Link * const *links, const unsigned *order,
+            int cell_idx, unsigned values) const;
+};
+
+/*!
+ * \brief collects the conclusions of several assumptions of which one
+ * must be true and finds a conclusion common to all of them.
+ *
+ * the common conclusions are the intersection of the candidate sets of all
+ * assumptions. only the links of candidates still in the intersection are
+ * remembered, to build the chains of a hint.
+ */
+class ConclusionMap {
+    struct Entry {
+        short candidate;
+        bool strong;
+        Link *link;
+    };
+    CandidateSet strong_all;
+    CandidateSet strong_any;
+    CandidateSet weak_all;
+    int branches;
+    std::vector<Entry> entries;
+public:
     /*!
-     * \brief finds a matching weak link in the list of weak links
-     * \param link the link to find
-     * \return the link found or null if no matching link has been found
+     * \brief constructor
      */
-    Link *find_weak_link(const Link *link);
+    ConclusionMap();
+
     /*!
-     * \brief finds a matching strong link in the list of strong links
-     * \param link the link to find
-     * \return the link found or null if no matching link has been found
+     * \brief adds the conclusions of one more assumption
+     * \param link_map the links of the assumption
      */
-    Link *find_strong_link(const Link *link);
+    void insert_all(const LinkMap &link_map);
+
     /*!
-     * \brief builds a histogram of all values in a given list of links
-     * \param links the list of links to compute the histogram of
-     * \param frequencies the histogram of values
+     *  \brief finds a conclusion common to all assumptions. a strong
+     *  conclusion is only taken, if no assumption leads to an other value
+     *  of the cell.
+     *  \param conclusions the links of the conclusion, one per assumption
+     *  \return true, if a conclusion has been found
      */
-    void build_frequencies(const std::vector<Link *> &links,
-            size_t frequencies[10]) const;
-
+    bool find_common_conclusion(std::vector<Link *> &conclusions) const;
+private:
+    void collect(bool strong, int candidate,
+            std::vector<Link *> &conclusions) const;
+    ConclusionMap(const ConclusionMap &other) {
+    }
+    ConclusionMap &operator =(const ConclusionMap &other) {
+        return *this;
+    }
 };
 
 /*!
@@ -369,14 +395,13 @@ private:
 
     /*!
      * \brief tries to find a common conclusion
-     * \param allLinks the LinkMap to find the common conclusion in
-     * \param nconclusions the numer of links the common conclusion must contain
+     * \param allLinks the ConclusionMap to find the common conclusion in
      * \param grid the ForcingChainConclusionHint will be applied to
      * \param consumer the HintConsumer which will consume the ForcingChainConclusionHint
      * \return true, if a common conclusion has been found
      */
-    bool find_common_conclusion(LinkMap &allLinks, size_t nconclusions,
-            Grid &grid, HintConsumer &consumer) const;
+    bool find_common_conclusion(ConclusionMap &allLinks, Grid &grid,
+            HintConsumer &consumer) const;
 
     /*!
      * \brief finds all strong links resulting as conclusion from a given link.
@@ -449,4 +474,61 @@ inline int LinkEntry::get_value() const {
     return value;
 }
 
+inline Link::Link(Link *parent, int cell_idx, int value, bool strong) :
+    parent(parent), first_child(0), last_child(0), next_sibling(0),
+            cell_idx(static_cast<unsigned char> (cell_idx)),
+            value(static_cast<unsigned char> (value)), strong(strong) {
+    if (parent) {
+        if (parent->last_child)
+            parent->last_child->next_sibling = this;
+        else
+            parent->first_child = this;
+        parent->last_child = this;
+    }
+}
+
+inline const Link *Link::get_parent() const {
+    return parent;
+}
+
+inline Link *Link::get_parent() {
+    return parent;
+}
+
+inline int Link::get_cell_idx() const {
+    return cell_idx;
+}
+
+inline int Link::get_value() const {
+    return value;
+}
+
+inline Link *Link::get_first_child() const {
+    return first_child;
+}
+
+inline Link *Link::get_next_sibling() const {
+    return next_sibling;
+}
+
+inline bool Link::is_strong_link() const {
+    return strong;
+}
+
+inline const CandidateSet &LinkMap::get_strong_set() const {
+    return strong_set;
+}
+
+inline const CandidateSet &LinkMap::get_weak_set() const {
+    return weak_set;
+}
+
+inline Link *LinkMap::get_strong_link(int cell_idx, int value) const {
+    return strong_links[cell_idx * 9 + value - 1];
+}
+
+inline Link *LinkMap::get_weak_link(int cell_idx, int value) const {
+    return weak_links[cell_idx * 9 + value - 1];
+}
+
 #endif
@@ -31,9 +31,17 @@
  */
 
 #include <iostream>
+#include <cctype>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
 
 #include "range.hpp"
 #include "grid.hpp"
+#include "propagation.hpp"
+
+static_assert(std::is_trivially_copyable<GridState>::value,
+        "a grid state must be copied as a flat block of memory");
 
 void Cell::print_choices(std::ostream &out) const {
     int count = 0;
@@ -42,11 +50,9 @@ void Cell::print_choices(std::ostream &out) const {
         out << get_value();
         ++count;
     } else {
-        for (int i = 1; i < 10; ++i) {
-            if (has_choice(i)) {
-                out << i;
-                ++count;
-            }
+        for (int i = first_choice(); i != 0; i = choices.next_choice(i)) {
+            out << i;
+            ++count;
         }
     }
 
@@ -70,6 +76,23 @@ void Grid::load(std::istream &in) {
     cleanup_choices();
 }
 
+bool Grid::load(const char *begin, const char *end) {
+    init_cells();
+
+    int i = 0;
+    for (const char *p = begin; p != end && i < 81; ++p) {
+        if (isspace((unsigned char) *p))
+            continue;
+        int v = *p >= '1' && *p <= '9' ? *p - '0' : 0;
+        cells[i++].set_value(v);
+    }
+    if (i < 81)
+        return false;
+
+    cleanup_choices();
+    return true;
+}
+
 void Grid::print(std::ostream &out) const {
     int i;
     int row;
@@ -124,34 +147,107 @@ void Grid::print_status(std::ostream &out) const {
             << std::endl;
 }
 
+void Grid::get_house_values(unsigned short used[27]) const {
+    std::fill(used, used + 27, 0);
+    for (int i = 0; i < 81; ++i) {
+        const Cell &cell = cells[i];
+        if (cell.has_value()) {
+            unsigned short bit = 1 << (cell.get_value() - 1);
+            used[cell.get_row()] |= bit;
+            used[9 + cell.get_col()] |= bit;
+            used[18 + cell.get_block_idx()] |= bit;
+        }
+    }
+}
+
+bool Grid::has_all_choices() const {
+    unsigned short used[27];
+
+    get_house_values(used);
+    for (int i = 0; i < 81; ++i) {
+        const Cell &cell = cells[i];
+        unsigned short expected = cell.has_value() ? 0 : 0x1ff
+                & ~(used[cell.get_row()] | used[9 + cell.get_col()] | used[18
+                        + cell.get_block_idx()]);
+        if (cell.get_choices().get_mask() != expected)
+            return false;
+    }
+    return true;
+}
+
+void Grid::cleanup_choices() {
+    unsigned short used[27];
+
+    get_house_values(used);
+
+    /*
+     * the values of all houses are removed from the whole grid in one
+     * pass; solved cells lose all of their choices.
+     */
+    unsigned short masks[81];
+    unsigned short forbidden[81];
+    get_choice_masks(masks);
+    for (int i = 0; i < 81; ++i) {
+        const Cell &cell = cells[i];
+        if (cell.has_value())
+            forbidden[i] = 0x1ff;
+        else
+            forbidden[i] = used[cell.get_row()] | used[9 + cell.get_col()]
+                    | used[18 + cell.get_block_idx()];
+    }
+
+    if (!Propagation::eliminate(masks, forbidden, 81))
+        return;
+
+    for (int i = 0; i < 81; ++i) {
+        if (masks[i] != cells[i].get_choices().get_mask())
+            set_choices(cells[i], Choices(masks[i]));
+    }
+}
+
+void Grid::remove_choices(const CandidateSet &candidates) {
+    Bitboard affected;
+    for (int i = 0; i < 9; ++i)
+        affected |= candidates.get_cells(i + 1) & positions[i];
+
+    for (int idx = affected.first(); idx != -1; idx = affected.next(idx)) {
+        Cell &cell = cells[idx];
+        Choices choices = cell.get_choices();
+        choices.remove_choices(Choices(candidates.get_values(idx)));
+        set_choices(cell, choices);
+    }
+}
+
 void Grid::cleanup_choice(Cell &cell) {
     if (!cell.has_value()) {
         return;
     }
 
-    cell.clear_choices();
+    clear_choices(cell);
 
     RangeList::const_index_iterator begin = RANGES.field_begin(cell.get_idx());
     RangeList::const_index_iterator end = RANGES.field_end(cell.get_idx());
 
     for (RangeList::const_index_iterator j = begin; j != end; ++j) {
-        cells[*j].remove_choice(cell.get_value());
+        remove_choice(cells[*j], cell.get_value());
     }
 }
 
 void Grid::remove_invalid_cell_choices(Cell &cell) {
     if (cell.has_value()) {
-        cell.clear_choices();
+        clear_choices(cell);
         return;
     }
 
+    Choices choices = cell.get_choices();
     RangeList::const_index_iterator begin = RANGES.field_begin(cell.get_idx());
     RangeList::const_index_iterator end = RANGES.field_end(cell.get_idx());
     for (RangeList::const_index_iterator j = begin; j != end; ++j) {
         if (cells[*j].has_value()) {
-            cell.remove_choice(cells[*j].get_value());
+            choices.remove_choice(cells[*j].get_value());
         }
     }
+    set_choices(cell, choices);
 }
 
 void Grid::clear_cell_value(Cell &cell) {
@@ -159,8 +255,10 @@ void Grid::clear_cell_value(Cell &cell) {
         return;
 
     int value = cell.get_value();
+    if (undo_log)
+        record(cell);
     cell.set_value(0);
-    cell.set_all_choices();
+    set_choices(cell, Choices());
     remove_invalid_cell_choices(cell);
 
     RangeList::const_index_iterator begin = RANGES.field_begin(cell.get_idx());
@@ -169,8 +267,42 @@ void Grid::clear_cell_value(Cell &cell) {
     for (RangeList::const_index_iterator j = begin; j != end; ++j) {
         Cell &c = cells[*j];
         if (!c.has_value()) {
-            c.add_choice(value);
+            add_choice(c, value);
             remove_invalid_cell_choices(c);
         }
     }
 }
+
+unsigned Grid::create_serial() {
+    static std::atomic<unsigned> next_serial(0);
+    return ++next_serial;
+}
+
+void Grid::undo(size_t mark) {
+    std::vector<CellState> *log = undo_log;
+    undo_log = 0;
+    while (log->size() > mark) {
+        const CellState &state = log->back();
+        Cell &cell = cells[state.idx];
+        cell.set_value(state.value);
+        set_choices(cell, Choices(state.choices));
+        log->pop_back();
+    }
+    undo_log = log;
+}
+
+void Grid::init_positions() {
+    for (int value = 0; value < 9; ++value)
+        positions[value].clear();
+    for (int house = 0; house < 27; ++house)
+        for (int value = 0; value < 9; ++value)
+            house_positions[house][value] = 0;
+
+    Choices none(0);
+    for (int i = 0; i < 81; ++i) {
+        Cell &cell = cells[i];
+        Choices choices = cell.get_choices();
+        cell.set_choices(none);
+        set_choices(cell, choices);
+    }
+}
@@ -33,16 +33,23 @@
 #ifndef GRID_HPP_
 #define GRID_HPP_
 
-#include <vector>
 #include <iosfwd>
+#include <algorithm>
+#include <vector>
+
+#include "bitops.hpp"
+#include "bitboard.hpp"
+#include "candidateset.hpp"
 
 /*!
  * \brief
  * maintains a list of choices (possible values) for a given cell.
+ *
+ * the choices are stored as a bit mask. bit (value - 1) is set, if value
+ * is a valid choice.
  */
 class Choices {
-    bool choices[10];
-    int num_choices;
+    unsigned short choices;
 public:
     /*!
      * \brief
@@ -52,16 +59,10 @@ public:
 
     /*!
      * \brief
-     * copy constructor
+     * constructs the choices from a bit mask
+     * \param mask bit (value - 1) is set for every valid choice
      */
-    Choices(const Choices &others);
-
-    /*!
-     * \brief
-     * assignment operator
-     * \return this
-     */
-    Choices & operator =(const Choices &others);
+    explicit Choices(unsigned int mask);
 
     /*!
      * \brief returns the number of choices left
@@ -105,34 +106,75 @@ public:
      * returns the first valid choice or '0' if there is no choice left.
      */
     int first_choice() const;
+
+    /**
+     * returns the smallest valid choice greater than value or '0' if
+     * there is no such choice.
+     *
+     * together with first_choice this iterates over all valid choices:
+     *
+     * \verbatim
+     for (int v = c.first_choice(); v != 0; v = c.next_choice(v)) \endverbatim
+     */
+    int next_choice(int value) const;
+
+    /**
+     * returns the bit mask of the valid choices.
+     */
+    unsigned int get_mask() const;
+
+    /**
+     * adds all choices of other to this list of choices.
+     */
+    Choices &operator |=(const Choices &other);
+
+    /**
+     * keeps only the choices which are valid in this and in other.
+     */
+    Choices &operator &=(const Choices &other);
+
+    /**
+     * removes all choices of other from this list of choices.
+     */
+    void remove_choices(const Choices &other);
+
+    bool operator ==(const Choices &other) const;
+    bool operator !=(const Choices &other) const;
 };
 
+/**
+ * returns the union of two lists of choices.
+ */
+Choices operator |(const Choices &a, const Choices &b);
+
+/**
+ * returns the intersection of two lists of choices.
+ */
+Choices operator &(const Choices &a, const Choices &b);
+
 /**
  * a single cell of a sudoku puzzle
+ *
+ * a cell occupies four bytes and may be copied with memcpy.
  */
 class Cell {
-    int idx;
-    int value;
+    unsigned char idx;
+    unsigned char value;
     Choices choices;
 public:
     /**
      * Constructor
      *
-     * @param the cells index
+     * creates the top left cell (index 0).
      */
-    Cell(int idx);
+    Cell();
 
     /**
-     * copy constructor
+     * Constructor
      *
-     * @param other the cell to be copied
-     */
-    Cell(const Cell &other);
-
-    /**
-     * assignment operator
+     * @param the cells index
      */
-    Cell & operator =(const Cell &other);
+    Cell(int idx);
 
     /**
      * the cells value
@@ -141,13 +183,6 @@ public:
      */
     int get_value() const;
 
-    /**
-     * the cells value
-     *
-     * param value the cells value
-     */
-    void set_value(int value);
-
     /**
      * returns true, if the cell has a value
      *
@@ -201,25 +236,6 @@ public:
      */
     bool has_choice(int value) const;
 
-    /**
-     * adds a choice to the list of valid choices for this cell.
-     *
-     * @param value the choice to be added
-     */
-    void add_choice(int value);
-
-    /**
-     * removes a choice to the list of valid choices for this cell.
-     *
-     * @param value the choice to be removed
-     */
-    void remove_choice(int value);
-
-    /**
-     * clears the list of valid choices for this cell.
-     */
-    void clear_choices();
-
     /**
      * returns the number of valid choices for this cell.
      *
@@ -248,19 +264,103 @@ public:
      * @return the list of all valid choices.
      */
     const Choices &get_choices() const;
+private:
+    /*
+     * the value and the choices of a cell are changed by its grid only,
+     * since the grid keeps track of the positions of each choice and
+     * records the changes in its undo log.
+     */
+    friend class Grid;
+
+    /**
+     * the cells value
+     *
+     * param value the cells value
+     */
+    void set_value(int value);
+
+    /**
+     * adds a choice to the list of valid choices for this cell.
+     *
+     * @param value the choice to be added
+     */
+    void add_choice(int value);
+
+    /**
+     * removes a choice to the list of valid choices for this cell.
+     *
+     * @param value the choice to be removed
+     */
+    void remove_choice(int value);
+
+    /**
+     * clears the list of valid choices for this cell.
+     */
+    void clear_choices();
 
     /**
      * sets all choices to be a valid choice for this cell.
      */
     void set_all_choices();
+
+    /**
+     * replaces the list of valid choices for this cell.
+     */
+    void set_choices(const Choices &choices);
+};
+
+/**
+ * the state of a cell before a change, recorded in the undo log of a grid.
+ */
+struct CellState {
+    unsigned char idx;
+    unsigned char value;
+    unsigned short choices;
 };
 
-class Grid {
+/**
+ * the part of a grid which is copied with it: the cells, the positions of
+ * the choices and the epochs of the houses and values.
+ *
+ * the members are plain arrays only, so copying the state is a single
+ * flat copy of memory.
+ */
+struct GridState {
+    Cell cells[81];
+    Bitboard positions[9];
+    unsigned short house_positions[27][9];
+    unsigned epoch;
+    unsigned house_epochs[27];
+    unsigned value_epochs[9];
+};
+
+/**
+ * the 81 cells of a sudoku puzzle.
+ *
+ * the cells are stored inline. a grid does not allocate any memory and
+ * copying a grid is a plain copy of its GridState. the serial number and
+ * the undo log belong to the grid object and are not copied.
+ *
+ * besides the cells the grid maintains for each value the set of
+ * cells having this value as a valid choice and for each house
+ * (row, column or block) the positions within the house where the
+ * value may go. both are updated whenever the choices of a cell change
+ * and can be queried in constant time. the houses are numbered like
+ * the ranges in RANGES: rows 0..8, columns 9..17 and blocks 18..26.
+ * the position of a cell within a house is its index within the
+ * corresponding range.
+ *
+ * to try an assumption and take it back, the changes of the cells can be
+ * recorded in an undo log (see set_undo_log). undo then restores only the
+ * cells which were touched, instead of copying the whole grid.
+ */
+class Grid : private GridState {
 public:
-    typedef std::vector<Cell>::iterator iterator;
-    typedef std::vector<Cell>::const_iterator const_iterator;
+    typedef Cell *iterator;
+    typedef const Cell *const_iterator;
 private:
-    std::vector<Cell> cells;
+    unsigned serial;
+    std::vector<CellState> *undo_log;
 public:
     /**
      * Constructor
@@ -268,18 +368,16 @@ public:
     Grid();
 
     /**
-     * copy constructor
-     *
-     * @param other the grid to be copied
+     * copies a grid. the copy gets a new serial number and does not record
+     * its changes: the undo log of other holds the changes of other.
      */
     Grid(const Grid &other);
 
     /**
-     * assignment operator
-     *
-     * @param other the grid to assign to *this
+     * copies the state of other. the grid gets a new serial number and keeps
+     * its own undo log, the changes recorded before belong to the old state.
      */
-    Grid & operator =(const Grid &other);
+    Grid &operator =(const Grid &other);
 
     /**
      * initializes all cells
@@ -302,6 +400,19 @@ public:
      */
     void load(std::istream &in);
 
+    /**
+     * loads a grid from a character buffer.
+     *
+     * the characters are interpreted like in Grid::load(std::istream &)
+     * but without an intermediate stream: white space is skipped and the
+     * next 81 characters are the cells contents.
+     *
+     * @param begin the first character to read
+     * @param end the end of the buffer
+     * @return false if the buffer contains less than 81 cells
+     */
+    bool load(const char *begin, const char *end);
+
     /**
      * prints a grid in a row / column format.
      *
@@ -359,6 +470,40 @@ public:
      */
     void cleanup_choices();
 
+    /**
+     * returns true if each cell has exactly the choices left by
+     * cleanup_choices, i.e. no choice has been eliminated by hints.
+     *
+     * the grid is then completely described by its values.
+     */
+    bool has_all_choices() const;
+
+    /**
+     * returns a number identifying this grid and its contents: it changes
+     * whenever the grid is initialized, loaded, copied or assigned.
+     *
+     * together with get_epoch() it tells whether a grid seen before has
+     * been modified only through its choices since.
+     */
+    unsigned get_serial() const;
+
+    /**
+     * returns the current epoch. the epoch is incremented by every
+     * change of the choices of a cell.
+     */
+    unsigned get_epoch() const;
+
+    /**
+     * returns the houses (bit 0-26) whose choices changed after epoch.
+     */
+    unsigned get_changed_houses(unsigned epoch) const;
+
+    /**
+     * returns the values (bit 0-8 for the values 1-9) whose choices
+     * changed after epoch.
+     */
+    unsigned get_changed_values(unsigned epoch) const;
+
     /**
      * if the cell has a value, i.e. it is already solved.
      * this value is removed from the list of choices of all
@@ -387,6 +532,103 @@ public:
      */
     void clear_cell_value(Cell &cell);
 
+    /**
+     * sets the value of a cell. the choices are left unchanged,
+     * cleanup_choice removes them. the change is recorded in the
+     * undo log.
+     */
+    void set_cell_value(Cell &cell, int value);
+
+    /**
+     * starts recording the changes of the cells into log, a null log stops
+     * the recording. the log is not copied with the grid.
+     *
+     * @param log the log to record the changes in
+     */
+    void set_undo_log(std::vector<CellState> *log);
+
+    /**
+     * undoes the recorded changes until the undo log has the size mark.
+     * the epoch is still incremented for every restored cell.
+     *
+     * @param mark a size of the undo log taken before the changes
+     */
+    void undo(size_t mark);
+
+    /**
+     * removes a choice from the list of valid choices of a cell.
+     *
+     * @param cell a cell of this grid
+     * @param value the choice to be removed
+     */
+    void remove_choice(Cell &cell, int value);
+
+    /**
+     * adds a choice to the list of valid choices of a cell.
+     *
+     * @param cell a cell of this grid
+     * @param value the choice to be added
+     */
+    void add_choice(Cell &cell, int value);
+
+    /**
+     * clears the list of valid choices of a cell.
+     *
+     * @param cell a cell of this grid
+     */
+    void clear_choices(Cell &cell);
+
+    /**
+     * removes a set of candidates from the choices of the cells. every
+     * affected cell is updated only once.
+     *
+     * @param candidates the candidates to be removed
+     */
+    void remove_choices(const CandidateSet &candidates);
+
+    /**
+     * returns true, if at least one of the candidates is a valid choice.
+     *
+     * @param candidates the candidates to be tested
+     */
+    bool has_any_choice(const CandidateSet &candidates) const;
+
+    /**
+     * returns the set of cells having a value as a valid choice.
+     *
+     * @param value the value in the range 1..9
+     *
+     * @return the cells having value as a valid choice
+     */
+    const Bitboard &get_positions(int value) const;
+
+    /**
+     * returns the positions within a house where a value is a valid choice.
+     *
+     * @param house the house in the range 0..26
+     * @param value the value in the range 1..9
+     *
+     * @return a mask with bit i set, if value is a valid choice for the
+     *         cell at position i of the house
+     */
+    unsigned int get_house_positions(int house, int value) const;
+
+    /**
+     * returns all house position masks as one array of 27 * 9 lanes.
+     * lane house * 9 + value - 1 holds get_house_positions(house, value).
+     *
+     * @return the house position masks
+     */
+    const unsigned short *get_house_positions() const;
+
+    /**
+     * copies the choice masks of all cells (bit value - 1 set, if value
+     * is a valid choice) into masks.
+     *
+     * @param masks receives the 81 choice masks
+     */
+    void get_choice_masks(unsigned short masks[81]) const;
+
     /**
      * returns an iterator pointing to the first cell of the grid.
      *
@@ -432,89 +674,120 @@ public:
      * @return the cell of the grid
      */
     const Cell & operator[](int idx) const;
-};
+private:
+    /**
+     * replaces the choices of a cell and updates the positions
+     * of the values whose choice changed.
+     */
+    void set_choices(Cell &cell, const Choices &choices);
 
-inline Choices::Choices() :
-num_choices(9) {
-    std::fill(choices, choices + 10, true);
-}
+    /**
+     * recomputes the positions of all values from the cells.
+     */
+    void init_positions();
 
-inline Choices::Choices(const Choices &other) :
-num_choices(other.num_choices) {
-    std::copy(other.choices, other.choices + 10, choices);
-}
+    /**
+     * collects the values of each house as a bit mask.
+     */
+    void get_house_values(unsigned short used[27]) const;
 
-inline Choices &Choices::operator =(const Choices &other) {
-    if (this == &other)
-        return *this;
+    void record(const Cell &cell);
 
-    std::copy(other.choices, other.choices + 10, choices);
-    num_choices = other.num_choices;
+    static unsigned create_serial();
+};
 
-    return *this;
+inline Choices::Choices() :
+choices(0x1ff) {
+}
+
+inline Choices::Choices(unsigned int mask) :
+choices(static_cast<unsigned short>(mask & 0x1ff)) {
 }
 
 inline int Choices::get_num_choices() const {
-    return num_choices;
+    return count_bits(choices);
 }
 
 inline bool Choices::has_choice(int value) const {
-    return choices[value];
+    return (choices >> (value - 1)) & 1;
 }
 
 inline void Choices::add_choice(int value) {
-    if (choices[value] == false) {
-        choices[value] = true;
-        ++num_choices;
-    }
+    choices |= 1 << (value - 1);
 }
 
 inline void Choices::remove_choice(int value) {
-    if (choices[value] == true) {
-        choices[value] = false;
-        --num_choices;
-    }
+    choices &= ~(1 << (value - 1));
 }
 
 inline void Choices::clear() {
-    std::fill(choices, choices + 10, false);
-    num_choices = 0;
+    choices = 0;
 }
 
 inline void Choices::set_all() {
-    std::fill(choices, choices + 10, true);
-    num_choices = 9;
+    choices = 0x1ff;
 }
 
 inline int Choices::first_choice() const {
-    if (num_choices == 0)
+    if (choices == 0)
         return 0;
 
-    for (int i = 1; i < 10; ++i) {
-        if (choices[i])
-            return i;
-    }
+    return first_bit(choices) + 1;
+}
 
-    return 0;
+inline int Choices::next_choice(int value) const {
+    unsigned int rest = choices >> value;
+
+    if (rest == 0)
+        return 0;
+
+    return value + first_bit(rest) + 1;
 }
 
-inline Cell::Cell(int idx) :
-idx(idx), value(0), choices() {
+inline unsigned int Choices::get_mask() const {
+    return choices;
 }
 
-inline Cell::Cell(const Cell &other) :
-idx(other.idx), value(other.value), choices(other.choices) {
+inline Choices &Choices::operator |=(const Choices &other) {
+    choices |= other.choices;
+    return *this;
 }
 
-inline Cell &Cell::operator =(const Cell &other) {
-    if (this == &other)
-        return *this;
+inline Choices &Choices::operator &=(const Choices &other) {
+    choices &= other.choices;
+    return *this;
+}
 
-    idx = other.idx;
-    value = other.value;
-    choices = other.choices;
+inline void Choices::remove_choices(const Choices &other) {
+    choices &= ~other.choices;
+}
 
-    return *this;
+inline bool Choices::operator ==(const Choices &other) const {
+    return choices == other.choices;
+}
+
+inline bool Choices::operator !=(const Choices &other) const {
+    return choices != other.choices;
+}
+
+inline Choices operator |(const Choices &a, const Choices &b) {
+    Choices result(a);
+    result |= b;
+    return result;
+}
+
+inline Choices operator &(const Choices &a, const Choices &b) {
+    Choices result(a);
+    result &= b;
+    return result;
+}
+
+inline Cell::Cell() :
+idx(0), value(0), choices() {
+}
+
+inline Cell::Cell(int idx) :
+idx(static_cast<unsigned char>(idx)), value(0), choices() {
 }
 
 inline int Cell::get_value() const {
@@ -526,7 +799,7 @@ inline bool Cell::has_value() const {
 }
 
 inline void Cell::set_value(int value) {
-    this->value = value;
+    this->value = static_cast<unsigned char>(value);
 }
 
 inline int Cell::get_row() const {
@@ -577,28 +850,62 @@ inline void Cell::set_all_choices() {
     choices.set_all();
 }
 
-inline Grid::Grid() {
+inline void Cell::set_choices(const Choices &choices) {
+    this->choices = choices;
+}
+
+inline Grid::Grid() :
+    undo_log(0) {
     init_cells();
 }
 
-inline Grid::Grid(const Grid &other) {
-    cells = other.cells;
+inline Grid::Grid(const Grid &other) :
+    GridState(other), serial(create_serial()), undo_log(0) {
 }
 
 inline Grid &Grid::operator =(const Grid &other) {
-    if (this == &other)
-        return *this;
-
-    cells = other.cells;
-
+    if (this != &other) {
+        GridState::operator =(other);
+        serial = create_serial();
+    }
     return *this;
 }
 
 inline void Grid::init_cells() {
-    cells.clear();
     for (int i = 0; i < 81; ++i) {
-        cells.push_back(Cell(i));
+        cells[i] = Cell(i);
     }
+    serial = create_serial();
+    epoch = 0;
+    std::fill(house_epochs, house_epochs + 27, 0);
+    std::fill(value_epochs, value_epochs + 9, 0);
+    init_positions();
+}
+
+inline unsigned Grid::get_serial() const {
+    return serial;
+}
+
+inline unsigned Grid::get_epoch() const {
+    return epoch;
+}
+
+inline unsigned Grid::get_changed_houses(unsigned epoch) const {
+    unsigned changed = 0;
+    for (int house = 0; house < 27; ++house) {
+        if (house_epochs[house] > epoch)
+            changed |= 1 << house;
+    }
+    return changed;
+}
+
+inline unsigned Grid::get_changed_values(unsigned epoch) const {
+    unsigned changed = 0;
+    for (int value = 0; value < 9; ++value) {
+        if (value_epochs[value] > epoch)
+            changed |= 1 << value;
+    }
+    return changed;
 }
 
 inline int Grid::get_to_do() const {
@@ -619,19 +926,19 @@ inline int Grid::get_num_choices() const {
 }
 
 inline Grid::iterator Grid::begin() {
-    return cells.begin();
+    return cells;
 }
 
 inline Grid::iterator Grid::end() {
-    return cells.end();
+    return cells + 81;
 }
 
 inline Grid::const_iterator Grid::begin() const {
-    return cells.begin();
+    return cells;
 }
 
 inline Grid::const_iterator Grid::end() const {
-    return cells.end();
+    return cells + 81;
 }
 
 inline Cell &Grid::operator[](int idx) {
@@ -642,10 +949,100 @@ inline const Cell & Grid::operator[](int idx) const {
     return cells[idx];
 }
 
-inline void Grid::cleanup_choices() {
-    for (iterator i = begin(); i != end(); ++i) {
-        cleanup_choice(*i);
+inline void Grid::remove_choice(Cell &cell, int value) {
+    if (cell.has_choice(value)) {
+        Choices choices = cell.get_choices();
+        choices.remove_choice(value);
+        set_choices(cell, choices);
     }
 }
 
+inline void Grid::add_choice(Cell &cell, int value) {
+    if (!cell.has_choice(value)) {
+        Choices choices = cell.get_choices();
+        choices.add_choice(value);
+        set_choices(cell, choices);
+    }
+}
+
+inline void Grid::clear_choices(Cell &cell) {
+    set_choices(cell, Choices(0));
+}
+
+inline bool Grid::has_any_choice(const CandidateSet &candidates) const {
+    Bitboard common;
+    for (int i = 0; i < 9; ++i)
+        common |= candidates.get_cells(i + 1) & positions[i];
+    return common.any();
+}
+
+inline const Bitboard &Grid::get_positions(int value) const {
+    return positions[value - 1];
+}
+
+inline unsigned int Grid::get_house_positions(int house, int value) const {
+    return house_positions[house][value - 1];
+}
+
+inline const unsigned short *Grid::get_house_positions() const {
+    return house_positions[0];
+}
+
+inline void Grid::get_choice_masks(unsigned short masks[81]) const {
+    for (int i = 0; i < 81; ++i)
+        masks[i] = cells[i].get_choices().get_mask();
+}
+
+inline void Grid::record(const Cell &cell) {
+    CellState state = { static_cast<unsigned char> (cell.get_idx()),
+            static_cast<unsigned char> (cell.get_value()),
+            static_cast<unsigned short> (cell.get_choices().get_mask()) };
+    undo_log->push_back(state);
+}
+
+inline void Grid::set_cell_value(Cell &cell, int value) {
+    if (undo_log)
+        record(cell);
+    cell.set_value(value);
+}
+
+inline void Grid::set_undo_log(std::vector<CellState> *log) {
+    undo_log = log;
+}
+
+inline void Grid::set_choices(Cell &cell, const Choices &choices) {
+    unsigned int changed = cell.get_choices().get_mask() ^ choices.get_mask();
+    if (changed == 0)
+        return;
+
+    if (undo_log)
+        record(cell);
+    cell.set_choices(choices);
+
+    int idx = cell.get_idx();
+    int row = cell.get_row();
+    int col = cell.get_col();
+    unsigned short *row_positions = house_positions[row];
+    unsigned short *col_positions = house_positions[9 + col];
+    unsigned short *block_positions = house_positions[18
+            + cell.get_block_idx()];
+    int block_pos = row % 3 * 3 + col % 3;
+
+    ++epoch;
+    house_epochs[row] = epoch;
+    house_epochs[9 + col] = epoch;
+    house_epochs[18 + cell.get_block_idx()] = epoch;
+
+    while (changed != 0) {
+        int i = first_bit(changed);
+        changed &= changed - 1;
+        value_epochs[i] = epoch;
+        positions[i].flip(idx);
+        row_positions[i] ^= 1 << col;
+        col_positions[i] ^= 1 << row;
+        block_positions[i] ^= 1 << block_pos;
+    }
+}
+
+
 #endif
@@ -30,37 +30,33 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <memory>
 #include "gridchecker.hpp"
-#include "dlxsolver.hpp"
 #include "grid.hpp"
+#include "solutioncache.hpp"
 
-class SingleSolutionListener: public SolutionListener {
-private:
-    int count;
-public:
-    SingleSolutionListener();
-    bool solution_found(const std::vector<Node *> &rows);
-    int get_count() const;
-};
-
-SingleSolutionListener::SingleSolutionListener() :
-    count(0) {
-}
-
-bool SingleSolutionListener::solution_found(const std::vector<Node *> &rows) {
-    ++count;
-    return count > 1;
+GridChecker::GridChecker(EngineType engine_type) :
+    solver(create_solver_engine(engine_type)), cache(0) {
 }
 
-int SingleSolutionListener::get_count() const {
-    return count;
+void GridChecker::set_cache(SolutionCache *cache) {
+    this->cache = cache;
 }
 
 bool GridChecker::check(const Grid &grid) {
-    SingleSolutionListener listener;
-    DlxSudokuSolver solver(&listener);
-    Grid copy = grid;
-    solver.solve(copy);
-    return listener.get_count() == 1;
+    if (!cache || !grid.has_all_choices())
+        return solver->is_unique(grid);
+
+    unsigned char canonical[81];
+    Transformation transformation;
+    canonicalizer.canonicalize(grid, canonical, transformation);
+    std::string key = SolutionCache::make_key(canonical);
+
+    CacheEntry entry;
+    if (cache->lookup(key, entry) && entry.solutions != CacheEntry::UNKNOWN)
+        return entry.solutions == 1;
+
+    entry = CacheEntry();
+    entry.solutions = solver->count_solutions(grid, 2).count;
+    cache->store(key, entry);
+    return entry.solutions == 1;
 }
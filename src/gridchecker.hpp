@@ -33,10 +33,35 @@
 #ifndef CHECKER_HPP_
 #define CHECKER_HPP_
 
+#include <memory>
+#include "solverengine.hpp"
+#include "canonicalform.hpp"
+
 class Grid;
+class SolutionCache;
 
+/**
+ * Checks that a grid has exactly one solution. The solver (and its matrix)
+ * is kept between checks.
+ *
+ * With a cache the number of solutions is looked up by the canonical form
+ * of the grid first. Grids with eliminated choices bypass the cache.
+ */
 class GridChecker {
+private:
+    std::unique_ptr<SolverEngine> solver;
+    SolutionCache *cache;
+    Canonicalizer canonicalizer;
 public:
+    GridChecker(EngineType engine_type = ENGINE_DLX);
     bool check(const Grid &grid);
+    /*! \brief sets the cache to use or 0, the cache is not owned */
+    void set_cache(SolutionCache *cache);
+private:
+    GridChecker(const GridChecker &other) {
+    }
+    GridChecker &operator =(const GridChecker &other) {
+        return *this;
+    }
 };
 #endif
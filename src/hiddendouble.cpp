@@ -68,10 +68,10 @@ void HiddenDoubleHintProducer::build_frequencies(Grid &grid,
         Cell &cell = grid[*i];
         if (cell.has_value())
             continue;
-        for (int value = 1; value < 10; ++value) {
-            if (cell.has_choice(value))
-                frequencies[value].push_back(&cell);
-        }
+        const Choices &choices = cell.get_choices();
+        for (int value = choices.first_choice(); value != 0; value
+                = choices.next_choice(value))
+            frequencies[value].push_back(&cell);
     }
 }
 
@@ -127,11 +127,12 @@ HiddenDoubleHint *HiddenDoubleHintProducer::create_hint(const std::vector<
     HiddenDoubleHint *hint = new HiddenDoubleHint(cells, values, range);
     for (std::vector<Cell *>::const_iterator i = cells.begin(); i
             != cells.end(); ++i) {
-        for (int value = 1; value <= 9; ++value) {
-            if (value != values.first && value != values.second
-                    && (*i)->has_choice(value))
-                hint->add_choice_to_remove(*i, value);
-        }
+        Choices others = (*i)->get_choices();
+        others.remove_choice(values.first);
+        others.remove_choice(values.second);
+        for (int value = others.first_choice(); value != 0; value
+                = others.next_choice(value))
+            hint->add_choice_to_remove(*i, value);
     }
     return hint;
 }
@@ -32,7 +32,6 @@
 
 #include <iostream>
 #include <vector>
-#include <set>
 #include <bitset>
 
 #include "hiddentriple.hpp"
@@ -63,19 +62,16 @@ const char *HiddenTripleHint::get_name() const {
 
 void HiddenTripleHintProducer::fill_potential_values(const Range &range,
         Grid &grid, std::vector<int> &potentialvalues) const {
-    std::set<int> v;
+    Choices v(0);
 
     for (Range::const_iterator i = range.begin(); i != range.end(); ++i) {
         const Cell &cell = grid[*i];
-        if (!cell.has_value()) {
-            for (int value = 1; value < 10; ++value) {
-                if (cell.has_choice(value))
-                    v.insert(value);
-            }
-        }
+        if (!cell.has_value())
+            v |= cell.get_choices();
     }
 
-    std::copy(v.begin(), v.end(), std::back_inserter(potentialvalues));
+    for (int value = v.first_choice(); value != 0; value = v.next_choice(value))
+        potentialvalues.push_back(value);
 }
 
 HiddenTripleHintProducer::HiddenTripleHintProducer() :
@@ -83,12 +79,9 @@ HiddenTripleHintProducer::HiddenTripleHintProducer() :
 
 }
 
-void HiddenTripleHintProducer::get_positions(const Range &range, Grid &grid,
+void HiddenTripleHintProducer::get_positions(int house, Grid &grid,
         int value, std::bitset<9> &positions) const {
-    for (int i = 0; i < 9; ++i) {
-        int idx = range[i];
-        positions[i] = grid[idx].has_choice(value);
-    }
+    positions = std::bitset<9>(grid.get_house_positions(house, value));
 }
 
 void HiddenTripleHintProducer::consume_possible_hint(const Range &range,
@@ -102,15 +95,18 @@ void HiddenTripleHintProducer::consume_possible_hint(const Range &range,
             cells.push_back(&cell);
         }
     }
+    Choices triple(0);
+    triple.add_choice(value1);
+    triple.add_choice(value2);
+    triple.add_choice(value3);
     bool ok = false;
     for (std::vector<Cell *>::const_iterator i = cells.begin(); i
             != cells.end(); ++i) {
-        for (int value = 1; value < 10; ++value) {
-            if (value != value1 && value != value2 && value != value3
-                    && (*i)->has_choice(value)) {
-                ok = true;
-                break;
-            }
+        Choices others = (*i)->get_choices();
+        others.remove_choices(triple);
+        if (others.get_num_choices() > 0) {
+            ok = true;
+            break;
         }
     }
     if (!ok)
@@ -119,7 +115,7 @@ void HiddenTripleHintProducer::consume_possible_hint(const Range &range,
 }
 
 void HiddenTripleHintProducer::find_sets_for_range(const Range &range,
-        Grid &grid, HintConsumer &consumer) const {
+        int house, Grid &grid, HintConsumer &consumer) const {
     std::vector<int> potenialvalues;
     fill_potential_values(range, grid, potenialvalues);
     if (potenialvalues.size() < degree) {
@@ -130,13 +126,13 @@ void HiddenTripleHintProducer::find_sets_for_range(const Range &range,
     int size = potenialvalues.size();
     for (int i = 0; i < size; ++i) {
         int value1 = potenialvalues[i];
-        get_positions(range, grid, value1, v[0]);
+        get_positions(house, grid, value1, v[0]);
         for (int j = i + 1; j < size; ++j) {
             int value2 = potenialvalues[j];
-            get_positions(range, grid, value2, v[1]);
+            get_positions(house, grid, value2, v[1]);
             for (int k = j + 1; k < size; ++k) {
                 int value3 = potenialvalues[k];
-                get_positions(range, grid, value3, v[2]);
+                get_positions(house, grid, value3, v[2]);
                 std::bitset<9> check;
                 for (size_t l = 0; l < degree; ++l) {
                     check |= v[l];
@@ -153,9 +149,11 @@ void HiddenTripleHintProducer::find_sets_for_range(const Range &range,
 }
 
 void HiddenTripleHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
+    int house = 0;
+
     for (RangeList::const_iterator irange = RANGES.begin(); irange
-            != RANGES.end(); ++irange) {
-        find_sets_for_range(*irange, grid, consumer);
+            != RANGES.end(); ++irange, ++house) {
+        find_sets_for_range(*irange, house, grid, consumer);
         if (!consumer.wants_more_hints())
             return;
     }
@@ -166,15 +164,18 @@ HiddenTripleHint *HiddenTripleHintProducer::create_hint(const std::vector<
     HiddenTripleHint *hint = new HiddenTripleHint(cells, value1, value2,
             value3, range);
 
+    Choices triple(0);
+    triple.add_choice(value1);
+    triple.add_choice(value2);
+    triple.add_choice(value3);
     for (std::vector<Cell *>::const_iterator i = cells.begin(); i
             != cells.end(); ++i) {
-        for (int value = 1; value < 10; ++value) {
-            if (value != value1 && value != value2 && value != value3) {
-                Cell &cell = *(*i);
-                if (cell.has_choice(value))
-                    hint->add_choice_to_remove(&cell, value);
-            }
-        }
+        Cell &cell = *(*i);
+        Choices others = cell.get_choices();
+        others.remove_choices(triple);
+        for (int value = others.first_choice(); value != 0; value
+                = others.next_choice(value))
+            hint->add_choice_to_remove(&cell, value);
     }
 
     return hint;
@@ -62,13 +62,13 @@ public:
 private:
     void fill_potential_values(const Range &range, Grid &grid,
             std::vector<int> &potentialvalues) const;
-    void get_positions(const Range &range, Grid &grid, int value,
+    void get_positions(int house, Grid &grid, int value,
             std::bitset<9> &positions) const;
 
     void consume_possible_hint(const Range &range, Grid &grid,
             std::bitset<9> &positions, int value1, int value2, int value3,
             HintConsumer &consumer) const;
-    void find_sets_for_range(const Range &range, Grid &grid,
+    void find_sets_for_range(const Range &range, int house, Grid &grid,
             HintConsumer &consumer) const;
     HiddenTripleHint *create_hint(const std::vector<Cell *> &cells, int value1, int value2,
             int value3, const Range &range) const;
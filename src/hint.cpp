@@ -32,3 +32,80 @@
 
 #include "hint.hpp"
 
+
+#include <new>
+
+namespace {
+
+/*
+ * hints are recycled in size classes of HINT_GRANULE bytes. larger hints
+ * and hints exceeding the capacity of a class go to the heap.
+ */
+const std::size_t HINT_GRANULE = 16;
+const int HINT_CLASSES = 16;
+const int HINT_CLASS_CAPACITY = 256;
+
+class HintPool {
+    void *blocks[HINT_CLASSES][HINT_CLASS_CAPACITY];
+    int counts[HINT_CLASSES];
+public:
+    HintPool();
+    ~HintPool();
+    void *allocate(std::size_t size);
+    void deallocate(void *p, std::size_t size);
+private:
+    HintPool(const HintPool &other) {
+    }
+
+    HintPool &operator =(const HintPool &other) {
+        return *this;
+    }
+};
+
+HintPool::HintPool() {
+    for (int i = 0; i < HINT_CLASSES; ++i)
+        counts[i] = 0;
+}
+
+HintPool::~HintPool() {
+    for (int i = 0; i < HINT_CLASSES; ++i) {
+        for (int j = 0; j < counts[i]; ++j)
+            ::operator delete(blocks[i][j]);
+        counts[i] = 0;
+    }
+}
+
+void *HintPool::allocate(std::size_t size) {
+    std::size_t size_class = (size - 1) / HINT_GRANULE;
+    if (size_class >= static_cast<std::size_t> (HINT_CLASSES))
+        return ::operator new(size);
+    if (counts[size_class] > 0)
+        return blocks[size_class][--counts[size_class]];
+    return ::operator new((size_class + 1) * HINT_GRANULE);
+}
+
+void HintPool::deallocate(void *p, std::size_t size) {
+    std::size_t size_class = (size - 1) / HINT_GRANULE;
+    if (size_class < static_cast<std::size_t> (HINT_CLASSES)
+            && counts[size_class] < HINT_CLASS_CAPACITY)
+        blocks[size_class][counts[size_class]++] = p;
+    else
+        ::operator delete(p);
+}
+
+/*
+ * a hint may be deleted by an other thread than the one which created it,
+ * the block then simply moves to the pool of the deleting thread.
+ */
+thread_local HintPool pool;
+
+}
+
+void *Hint::operator new(std::size_t size) {
+    return pool.allocate(size);
+}
+
+void Hint::operator delete(void *p, std::size_t size) {
+    if (p)
+        pool.deallocate(p, size);
+}
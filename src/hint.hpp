@@ -34,6 +34,7 @@
 #define HINT_HPP_
 
 #include <iosfwd>
+#include <cstddef>
 
 class HintConsumer;
 class Grid;
@@ -49,6 +50,10 @@ class Grid;
  * Hints are normally processed by a hint consumer which is responsible
  * to apply the hint to the sudoku grid. Applying means, that the new
  * field values are set and all impossible remaining choices are removed.
+ *
+ * Hints are created and deleted for every step, the forcing chains even
+ * create thousands of them per step. Their memory is therefore recycled
+ * by a per thread pool instead of going through the heap each time.
  */
 
 class Hint {
@@ -65,11 +70,38 @@ public:
     virtual ~Hint() {
     }
 
+    /**
+     * Allocates the memory of a hint from the pool of the calling thread.
+     *
+     * @param size the size of the hint
+     */
+    static void *operator new(std::size_t size);
+
+    /**
+     * Returns the memory of a hint to the pool of the calling thread.
+     *
+     * @param p the memory of the hint
+     * @param size the size of the hint
+     */
+    static void operator delete(void *p, std::size_t size);
+
     /**
      * Applies the hint to the sudoku.
      */
     virtual void apply(Grid &grid) = 0;
 
+    /**
+     * Returns true, if applying the hint would still change the grid.
+     *
+     * A hint found on an earlier state of the grid may have become
+     * redundant, because an other hint already made the same deduction.
+     *
+     * @param grid the grid the hint would be applied to
+     */
+    virtual bool is_applicable(const Grid &grid) const {
+        return true;
+    }
+
     /**
      * Prints a description of the hint wich can be interpreted by a human user.
      *
@@ -108,6 +140,12 @@ private:
  */
 class HintProducer {
 public:
+    /**
+     * Destructor
+     */
+    virtual ~HintProducer() {
+    }
+
     /*!
      * \brief searches the grid for hints and feeds them into the hintconsumer.
      * \param grid the grid to be searched for hints
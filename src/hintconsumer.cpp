@@ -39,15 +39,48 @@
 #include "hint.hpp"
 
 
-SingleHintConsumer::SingleHintConsumer(Grid &grid) :
-    success(false), grid(grid) {
+SingleHintConsumer::SingleHintConsumer(Grid &grid, std::ostream &out) :
+    success(false), grid(grid), out(out) {
 }
 
 bool SingleHintConsumer::consume_hint(Hint *hint) {
-    hint->print_description(std::cout);
-    std::cout << std::endl;
+    hint->print_description(out);
+    out << std::endl;
     hint->apply(grid);
     delete hint;
     success = true;
     return false;
 }
+
+BatchHintConsumer::BatchHintConsumer(Grid &grid, std::ostream &out) :
+    grid(grid), out(out) {
+}
+
+BatchHintConsumer::~BatchHintConsumer() {
+    clear();
+}
+
+void BatchHintConsumer::clear() {
+    std::for_each(hints.begin(), hints.end(), destroy<Hint *> ());
+    hints.clear();
+}
+
+bool BatchHintConsumer::consume_hint(Hint *hint) {
+    hints.push_back(hint);
+    return true;
+}
+
+int BatchHintConsumer::apply_hints() {
+    int applied = 0;
+    for (std::vector<Hint *>::iterator i = hints.begin(); i != hints.end(); ++i) {
+        Hint *hint = *i;
+        if (!hint->is_applicable(grid))
+            continue;
+        hint->print_description(out);
+        out << std::endl;
+        hint->apply(grid);
+        ++applied;
+    }
+    clear();
+    return applied;
+}
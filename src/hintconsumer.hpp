@@ -35,6 +35,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <iostream>
 
 #include "hint.hpp"
 
@@ -42,13 +43,14 @@ class SingleHintConsumer: public HintConsumer {
 private:
     bool success;
     Grid &grid;
+    std::ostream &out;
 public:
-    SingleHintConsumer(Grid &grid);
+    SingleHintConsumer(Grid &grid, std::ostream &out = std::cout);
     bool consume_hint(Hint *hint);
     bool has_hints() const;
     bool wants_more_hints() const;
 private:
-    SingleHintConsumer(const SingleHintConsumer &other) : grid(other.grid) {
+    SingleHintConsumer(const SingleHintConsumer &other) : grid(other.grid), out(other.out) {
     }
 
     SingleHintConsumer &operator =(const SingleHintConsumer &other) {
@@ -56,6 +58,37 @@ private:
     }
 };
 
+/**
+ * Collects all hints of a producer pass and applies them together, so the
+ * grid is rescanned once per pass instead of once per hint.
+ *
+ * The hints are applied in the order they were found. A hint which became
+ * redundant through an earlier one (ex. the same hidden single found in the
+ * row and in the block) or which contradicts an earlier one is dropped.
+ */
+class BatchHintConsumer: public HintConsumer {
+private:
+    std::vector<Hint *> hints;
+    Grid &grid;
+    std::ostream &out;
+public:
+    BatchHintConsumer(Grid &grid, std::ostream &out = std::cout);
+    ~BatchHintConsumer();
+    bool consume_hint(Hint *hint);
+    bool has_hints() const;
+    bool wants_more_hints() const;
+    /*! \brief applies the collected hints and returns the number of applied ones */
+    int apply_hints();
+private:
+    void clear();
+    BatchHintConsumer(const BatchHintConsumer &other) : grid(other.grid), out(other.out) {
+    }
+
+    BatchHintConsumer &operator =(const BatchHintConsumer &other) {
+        return *this;
+    }
+};
+
 inline bool SingleHintConsumer::wants_more_hints() const {
     return !success;
 }
@@ -64,4 +97,12 @@ inline bool SingleHintConsumer::has_hints() const {
     return success;
 }
 
+inline bool BatchHintConsumer::wants_more_hints() const {
+    return true;
+}
+
+inline bool BatchHintConsumer::has_hints() const {
+    return !hints.empty();
+}
+
 #endif /* HINTCONSUMER_HPP_ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HOUSETRACKER_HPP_
+#define HOUSETRACKER_HPP_
+
+#include "grid.hpp"
+
+/**
+ * Remembers which parts of a grid a hint producer has searched without
+ * finding a hint, so that later searches can skip them while the houses
+ * they depend on do not change.
+ *
+ * A producer divides its search into up to 32 units (e.g. houses or blocks)
+ * and describes the houses each unit depends on by a mask. A unit is clean
+ * if it has been searched without result and none of its houses has
+ * changed since.
+ *
+ * The tracker follows one grid at a time; for any other grid (or after the
+ * grid has been loaded, copied or assigned) all units are dirty.
+ */
+class HouseTracker {
+private:
+    const Grid *grid;
+    unsigned serial;
+    unsigned epoch;
+    unsigned clean;
+public:
+    HouseTracker();
+    /**
+     * starts a search.
+     *
+     * @param grid the grid to search
+     * @param dependencies the houses each unit depends on
+     * @param units the number of units
+     */
+    void start(const Grid &grid, const unsigned *dependencies, int units);
+    bool is_clean(int unit) const;
+    /*! \brief marks a unit as searched without finding a hint */
+    void set_clean(int unit);
+private:
+    HouseTracker(const HouseTracker &other) {
+    }
+    HouseTracker &operator =(const HouseTracker &other) {
+        return *this;
+    }
+};
+
+inline HouseTracker::HouseTracker() :
+    grid(0), serial(0), epoch(0), clean(0) {
+}
+
+inline void HouseTracker::start(const Grid &grid,
+        const unsigned *dependencies, int units) {
+    if (this->grid != &grid || serial != grid.get_serial()) {
+        this->grid = &grid;
+        serial = grid.get_serial();
+        clean = 0;
+    } else {
+        unsigned changed = grid.get_changed_houses(epoch);
+        for (int unit = 0; unit < units; ++unit) {
+            if (dependencies[unit] & changed)
+                clean &= ~(1u << unit);
+        }
+    }
+    /*
+     * units searched from now on are clean as of the current epoch,
+     * changes made while searching are seen by the next search.
+     */
+    epoch = grid.get_epoch();
+}
+
+inline bool HouseTracker::is_clean(int unit) const {
+    return (clean >> unit) & 1;
+}
+
+inline void HouseTracker::set_clean(int unit) {
+    clean |= 1u << unit;
+}
+
+#endif /* HOUSETRACKER_HPP_ */
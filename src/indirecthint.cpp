@@ -35,24 +35,30 @@
 #include "util.hpp"
 
 void IndirectHint::add_choice_to_remove(Cell *cell, int value) {
-    choices_to_remove.push_back(std::pair<int, int>(cell->get_idx(), value));
+    choices_to_remove.set(cell->get_idx(), value);
 }
 
 void IndirectHint::apply(Grid &grid) {
-    for (std::vector<std::pair<int, int> >::iterator i =
-            choices_to_remove.begin(); i != choices_to_remove.end(); ++i) {
-        Cell &cell = grid[i->first];
-        cell.remove_choice(i->second);
-    }
+    grid.remove_choices(choices_to_remove);
+}
+
+bool IndirectHint::is_applicable(const Grid &grid) const {
+    return grid.has_any_choice(choices_to_remove);
 }
 
 
 void print_choices_to_remove::print(std::ostream &out) const {
-    for (std::vector<std::pair<int, int> >::const_iterator i =
-            choices_to_remove.begin(); i != choices_to_remove.end(); ++i) {
-        out << print_row_col(i->first) << "=" << i->second;
-        if ((i + 1) != choices_to_remove.end())
-            out << ' ';
+    Bitboard cells = choices_to_remove.get_cells();
+    bool first = true;
+    for (int idx = cells.first(); idx != -1; idx = cells.next(idx)) {
+        Choices values(choices_to_remove.get_values(idx));
+        for (int value = values.first_choice(); value != 0; value
+                = values.next_choice(value)) {
+            if (!first)
+                out << ' ';
+            out << print_row_col(idx) << "=" << value;
+            first = false;
+        }
     }
 }
 
@@ -34,29 +34,36 @@
 #define INDIRECTHINT_HPP_
 
 #include "hint.hpp"
-#include <vector>
-#include <utility>
+#include "candidateset.hpp"
 
 class Cell;
 
+/**
+ * a hint which only removes choices. the choices to remove are kept as a
+ * CandidateSet, so applying the hint and testing whether it is still
+ * useful takes a few word operations.
+ */
 class IndirectHint: public Hint {
-    std::vector<std::pair<int, int> > choices_to_remove;
+    CandidateSet choices_to_remove;
 public:
     void add_choice_to_remove(Cell *cell, int value);
-    const std::vector<std::pair<int, int> > &get_choices_to_remove() const;
+    const CandidateSet &get_choices_to_remove() const;
     void apply(Grid &grid);
+    bool is_applicable(const Grid &grid) const;
 };
 
 
-inline const std::vector<std::pair<int, int> > &IndirectHint::get_choices_to_remove() const {
+inline const CandidateSet &IndirectHint::get_choices_to_remove() const {
     return choices_to_remove;
 }
 
+/**
+ * prints the choices to remove ordered by cell and value.
+ */
 struct print_choices_to_remove {
-    const std::vector<std::pair<int, int> > &choices_to_remove;
+    const CandidateSet &choices_to_remove;
 
-    print_choices_to_remove(
-            const std::vector<std::pair<int, int> > &choices_to_remove) :
+    print_choices_to_remove(const CandidateSet &choices_to_remove) :
         choices_to_remove(choices_to_remove) {
 
     }
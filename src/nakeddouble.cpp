@@ -31,7 +31,6 @@
  */
 
 #include <iostream>
-#include <bitset>
 
 #include "nakeddouble.hpp"
 #include "range.hpp"
@@ -56,41 +55,55 @@ const char *NakedDoubleHint::get_name() const {
     return "Naked double";
 }
 
-void fill_bitset(Cell &cell, std::bitset<10> &bits) {
-    for (int value = 1; value < 10; ++value) {
-        bits[value] = cell.has_choice(value);
-    }
+void fill_values(const Cell &cell, std::vector<int> &values) {
+    const Choices &choices = cell.get_choices();
+    for (int value = choices.first_choice(); value != 0; value
+            = choices.next_choice(value))
+        values.push_back(value);
 }
 
-void fill_values(const Cell &cell, std::vector<int> &values) {
-    for (int value = 1; value < 10; ++value) {
-        if (cell.has_choice(value))
-            values.push_back(value);
+namespace {
+
+struct HouseDependencies {
+    unsigned houses[27];
+
+    HouseDependencies() {
+        for (int house = 0; house < 27; ++house)
+            houses[house] = 1u << house;
     }
+};
+
+const HouseDependencies HOUSE_DEPENDENCIES;
+
 }
 
 void NakedDoubleHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
-    std::vector<std::bitset<10> > bitsets(9);
+    Choices choices[9];
 
+    tracker.start(grid, HOUSE_DEPENDENCIES.houses, 27);
     for (RangeList::const_iterator irange = RANGES.begin(); irange
             != RANGES.end(); ++irange) {
+        int house = irange->get_house();
+        if (tracker.is_clean(house))
+            continue;
+        bool found = false;
         for (int i = 0; i < 9; ++i) {
             int idx = (*irange)[i];
-            Cell &cell = grid[idx];
-            fill_bitset(cell, bitsets[i]);
+            choices[i] = grid[idx].get_choices();
         }
 
         for (int i = 0; i < 9; ++i) {
-            if (bitsets[i].count() == 2) {
+            if (choices[i].get_num_choices() == 2) {
                 for (int j = i + 1; j < 9; ++j) {
-                    if (bitsets[i] == bitsets[j]) {
+                    if (choices[i] == choices[j]) {
                         for (int k = 0; k < 9; ++k) {
                             if (k != i && k != j) {
-                                if ((bitsets[i] & bitsets[k]).any()) {
+                                if ((choices[i] & choices[k]).get_num_choices() > 0) {
                                     int idx1 = (*irange)[i];
                                     int idx2 = (*irange)[j];
                                     std::vector<int> values;
                                     fill_values(grid[idx1], values);
+                                    found = true;
                                     if (!consumer.consume_hint(create_hint(
                                             grid, idx1, idx2, values[0],
                                             values[1], *irange)))
@@ -103,6 +116,8 @@ void NakedDoubleHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
                 }
             }
         }
+        if (!found)
+            tracker.set_clean(house);
     }
 }
 
@@ -34,6 +34,7 @@
 #define NAKED_DOUBLE_HPP
 
 #include "indirecthint.hpp"
+#include "housetracker.hpp"
 
 class Range;
 
@@ -49,7 +50,13 @@ public:
     const char *get_name() const;
 };
 
+/**
+ * Finds naked doubles. Houses searched without result are skipped until
+ * their choices change.
+ */
 class NakedDoubleHintProducer : public HintProducer {
+private:
+    HouseTracker tracker;
 public:
     void find_hints(Grid &grid, HintConsumer &consumer);
 private:
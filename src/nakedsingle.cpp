@@ -35,6 +35,7 @@
 #include "grid.hpp"
 #include "hintconsumer.hpp"
 #include "util.hpp"
+#include "propagation.hpp"
 
 NakedSingleHint::NakedSingleHint(int cell_idx, int value) :
     cell_idx(cell_idx), value(value) {
@@ -42,10 +43,15 @@ NakedSingleHint::NakedSingleHint(int cell_idx, int value) :
 
 void NakedSingleHint::apply(Grid &grid) {
     Cell &cell = grid[cell_idx];
-    cell.set_value(value);
+    grid.set_cell_value(cell, value);
     grid.cleanup_choice(cell);
 }
 
+bool NakedSingleHint::is_applicable(const Grid &grid) const {
+    const Cell &cell = grid[cell_idx];
+    return !cell.has_value() && cell.has_choice(value);
+}
+
 void NakedSingleHint::print_description(std::ostream &out) const {
     out << "naked single: " << print_row_col(cell_idx) << "="
             << value;
@@ -56,11 +62,20 @@ const char *NakedSingleHint::get_name() const {
 }
 
 void NakedSingleHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
-    Grid::iterator begin = grid.begin();
-    Grid::iterator end = grid.end();
-    for (Grid::iterator i = begin; i != end; ++i) {
-        Cell &cell = *i;
-        if (cell.get_num_choices() == 1) {
+    unsigned short masks[81];
+    unsigned singles[3];
+
+    grid.get_choice_masks(masks);
+    Propagation::find_single_bits(masks, 81, singles);
+
+    for (int word = 0; word < 3; ++word) {
+        for (unsigned bits = singles[word]; bits != 0; bits &= bits - 1) {
+            Cell &cell = grid[32 * word + first_bit(bits)];
+            /*
+             * the consumer may have changed the grid in the meantime
+             */
+            if (cell.get_num_choices() != 1)
+                continue;
             if (!consumer.consume_hint(new NakedSingleHint(cell.get_idx(), cell.first_choice())))
                 return;
         }
@@ -43,6 +43,7 @@ class NakedSingleHint: public Hint {
 public:
     NakedSingleHint(int cell_idx, int value);
     void apply(Grid &grid);
+    bool is_applicable(const Grid &grid) const;
     void print_description(std::ostream &out) const;
     const char *get_name() const;
 };
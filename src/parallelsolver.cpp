@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "parallelsolver.hpp"
+
+namespace {
+
+/*
+ * nodes searched between two checks of the stop flag and the budgets
+ */
+const long SLICE_NODES = 4096;
+
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<int> tasks;
+};
+
+struct SharedSearch {
+    const std::vector<std::vector<int> > &tasks;
+    std::vector<WorkQueue> queues;
+    std::mutex listener_mutex;
+    SolutionListener *listener;
+    int limit;
+    long max_nodes;
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> stop;
+    std::atomic<bool> limit_reached;
+    std::atomic<bool> budget_exhausted;
+    std::atomic<int> count;
+    std::atomic<long> nodes;
+    /*! \brief nodes of max_nodes not yet handed out to a slice */
+    std::atomic<long> budget;
+
+    SharedSearch(const std::vector<std::vector<int> > &tasks, int num_threads);
+    bool next_task(int worker, int &task);
+};
+
+SharedSearch::SharedSearch(const std::vector<std::vector<int> > &tasks,
+        int num_threads) :
+    tasks(tasks), queues(num_threads), listener(0), limit(0), max_nodes(0),
+            has_deadline(false), stop(false), limit_reached(false),
+            budget_exhausted(false), count(0), nodes(0), budget(0) {
+    for (int i = 0; i < (int) tasks.size(); ++i) {
+        queues[i % num_threads].tasks.push_back(i);
+    }
+}
+
+bool SharedSearch::next_task(int worker, int &task) {
+    int n = queues.size();
+
+    for (int i = 0; i < n; ++i) {
+        WorkQueue &queue = queues[(worker + i) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        if (i == 0) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        } else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+class ForwardingListener: public SolutionListener {
+private:
+    SharedSearch &shared;
+public:
+    ForwardingListener(SharedSearch &shared);
+    bool solution_found(const std::vector<Node *> &rows);
+};
+
+ForwardingListener::ForwardingListener(SharedSearch &shared) :
+    shared(shared) {
+}
+
+bool ForwardingListener::solution_found(const std::vector<Node *> &rows) {
+    std::lock_guard<std::mutex> lock(shared.listener_mutex);
+
+    if (shared.stop)
+        return true;
+    int count = ++shared.count;
+    if (shared.listener->solution_found(rows) || (shared.limit > 0 && count
+            >= shared.limit)) {
+        shared.limit_reached = true;
+        shared.stop = true;
+    }
+    return shared.stop;
+}
+
+/*
+ * takes the nodes of the next slice from the budget, so all workers
+ * together never search more than max_nodes. returns 0 if the budget is
+ * used up.
+ */
+long take_slice(SharedSearch &shared) {
+    if (shared.max_nodes <= 0)
+        return SLICE_NODES;
+    long left = shared.budget;
+    long slice;
+    do {
+        if (left <= 0)
+            return 0;
+        slice = std::min(left, SLICE_NODES);
+    } while (!shared.budget.compare_exchange_weak(left, left - slice));
+    return slice;
+}
+
+void search_task(SharedSearch &shared, Solver &solver, int task) {
+    const std::vector<int> &prefix = shared.tasks[task];
+    int mark = solver.get_undo_mark();
+    bool report = shared.listener != 0;
+    int counted = 0;
+    long visited = 0;
+
+    for (std::vector<int>::const_iterator i = prefix.begin(); i
+            != prefix.end(); ++i) {
+        solver.select_row(*i);
+    }
+
+    solver.start(report ? 0 : shared.limit, report);
+    for (;;) {
+        long slice = take_slice(shared);
+        if (slice == 0) {
+            shared.budget_exhausted = true;
+            shared.stop = true;
+            break;
+        }
+        SearchStatus status = solver.run(slice);
+
+        long used = solver.get_nodes_visited() - visited;
+        visited = solver.get_nodes_visited();
+        shared.nodes += used;
+        if (shared.max_nodes > 0)
+            shared.budget += slice - used;
+        if (!report) {
+            int count = shared.count += solver.get_count().count - counted;
+            counted = solver.get_count().count;
+            if (shared.limit > 0 && count >= shared.limit) {
+                shared.limit_reached = true;
+                shared.stop = true;
+            }
+        }
+
+        if (status == SEARCH_FINISHED)
+            break;
+        if (shared.has_deadline && std::chrono::steady_clock::now()
+                >= shared.deadline) {
+            shared.budget_exhausted = true;
+            shared.stop = true;
+        }
+        if (shared.stop)
+            break;
+    }
+
+    solver.rollback(mark);
+}
+
+void run_worker(SharedSearch *shared, int worker,
+        const NodeFactory *master_factory, const Solver *master) {
+    NodeFactory node_factory;
+    ForwardingListener listener(*shared);
+
+    node_factory.assign(*master_factory);
+    Solver solver(&node_factory, *master, &listener);
+
+    int task;
+    while (!shared->stop && shared->next_task(worker, task)) {
+        search_task(*shared, solver, task);
+    }
+}
+
+}
+
+ParallelSolver::ParallelSolver(int num_threads, int split_depth) :
+    num_threads(num_threads), split_depth(split_depth) {
+}
+
+ParallelSolver::~ParallelSolver() {
+}
+
+SolutionCount ParallelSolver::count_solutions(NodeFactory &node_factory,
+        Solver &solver, int limit, long max_nodes, double max_seconds) {
+    return search(node_factory, solver, 0, limit, max_nodes, max_seconds);
+}
+
+bool ParallelSolver::solve(NodeFactory &node_factory, Solver &solver,
+        SolutionListener *listener) {
+    return search(node_factory, solver, listener, 0, 0, 0).limit_reached;
+}
+
+SolutionCount ParallelSolver::search(NodeFactory &node_factory,
+        Solver &solver, SolutionListener *listener, int limit,
+        long max_nodes, double max_seconds) {
+    std::vector<std::vector<int> > tasks;
+    solver.split(split_depth, tasks);
+
+    SharedSearch shared(tasks, num_threads);
+    shared.listener = listener;
+    shared.limit = limit;
+    shared.max_nodes = max_nodes;
+    shared.budget = max_nodes;
+    if (max_seconds > 0) {
+        shared.has_deadline = true;
+        shared.deadline = std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<
+                        std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(max_seconds));
+    }
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_threads; ++i) {
+        workers.push_back(std::thread(run_worker, &shared, i, &node_factory,
+                &solver));
+    }
+    for (std::vector<std::thread>::iterator i = workers.begin(); i
+            != workers.end(); ++i) {
+        i->join();
+    }
+
+    SolutionCount count;
+    count.count = shared.count;
+    count.limit_reached = shared.limit_reached;
+    count.budget_exhausted = shared.budget_exhausted;
+    if (limit > 0 && count.count > limit)
+        count.count = limit;
+    return count;
+}
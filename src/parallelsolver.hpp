@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELSOLVER_HPP_
+#define PARALLELSOLVER_HPP_
+
+#include "dancinglinks.hpp"
+
+/**
+ * Runs a dancing links search on several threads.
+ *
+ * The first levels of the search tree are expanded into independent
+ * subproblems (see Solver::split()). Each worker thread searches them on a
+ * private copy of the matrix. The subproblems are dealt round robin to
+ * per thread queues; a worker whose queue runs empty steals from the
+ * others. Solutions are passed to the SolutionListener one at a time.
+ */
+class ParallelSolver {
+private:
+    int num_threads;
+    int split_depth;
+public:
+    ParallelSolver(int num_threads, int split_depth = 3);
+    virtual ~ParallelSolver();
+    /*!
+     * \brief counts up to limit solutions of the matrix of solver
+     *
+     * limit, max_nodes and max_seconds have the same meaning as for
+     * DlxSudokuSolver::count_solutions(). max_seconds is wall clock time.
+     */
+    SolutionCount count_solutions(NodeFactory &node_factory, Solver &solver,
+            int limit, long max_nodes = 0, double max_seconds = 0);
+    /*! \brief reports all solutions to listener, returns true if the listener stopped the search */
+    bool solve(NodeFactory &node_factory, Solver &solver,
+            SolutionListener *listener);
+private:
+    SolutionCount search(NodeFactory &node_factory, Solver &solver,
+            SolutionListener *listener, int limit, long max_nodes,
+            double max_seconds);
+    ParallelSolver(const ParallelSolver &other) {
+    }
+    ParallelSolver &operator =(const ParallelSolver &other) {
+        return *this;
+    }
+};
+
+#endif /* PARALLELSOLVER_HPP_ */
@@ -69,22 +69,26 @@ bool PointingHint::is_col_hint() const {
     return col != -1;
 }
 
-void PointingHintProducer::find_block_hint(int block_idx, Grid &grid,
+/**
+ * returns true if a hint has been found in the block.
+ */
+bool PointingHintProducer::find_block_hint(int block_idx, Grid &grid,
         HintConsumer &consumer) const {
     int start_row = (block_idx / 3) * 3;
     int start_col = (block_idx % 3) * 3;
     std::vector<std::set<int> > value_rows(10);
     std::vector<std::set<int> > value_cols(10);
+    bool found = false;
 
     for (int row = 0; row < 3; ++row) {
         for (int col = 0; col < 3; ++col) {
             int idx = (start_row + row) * 9 + (start_col + col);
             Cell &cell = grid[idx];
             if (!cell.has_value()) {
-                for (int value = 1; value < 10; ++value) {
-                    if (cell.has_choice(value)) {
-                        value_rows[value].insert(start_row + row);
-                    }
+                const Choices &choices = cell.get_choices();
+                for (int value = choices.first_choice(); value != 0; value
+                        = choices.next_choice(value)) {
+                    value_rows[value].insert(start_row + row);
                 }
             }
         }
@@ -98,9 +102,10 @@ void PointingHintProducer::find_block_hint(int block_idx, Grid &grid,
                 Cell &cell = grid[idx];
                 if (!cell.has_value() && (col < start_col || col >= start_col
                         + 3) && cell.has_choice(value)) {
+                    found = true;
                     if (!consumer.consume_hint(create_hint(grid, start_row,
                             start_col, value, row, -1)))
-                        return;
+                        return true;
                 }
             }
         }
@@ -112,10 +117,10 @@ void PointingHintProducer::find_block_hint(int block_idx, Grid &grid,
             Cell &cell = grid[idx];
 
             if (!cell.has_value()) {
-                for (int value = 1; value < 10; ++value) {
-                    if (cell.has_choice(value)) {
-                        value_cols[value].insert(start_col + col);
-                    }
+                const Choices &choices = cell.get_choices();
+                for (int value = choices.first_choice(); value != 0; value
+                        = choices.next_choice(value)) {
+                    value_cols[value].insert(start_col + col);
                 }
             }
         }
@@ -129,19 +134,50 @@ void PointingHintProducer::find_block_hint(int block_idx, Grid &grid,
                     int idx = 9 * row + col;
                     Cell cell = grid[idx];
                     if (!cell.has_value() && cell.has_choice(value)) {
+                        found = true;
                         if (!consumer.consume_hint(create_hint(grid, start_row,
                                 start_col, value, -1, col)))
-                            return;
+                            return true;
                     }
                 }
             }
         }
     }
+    return found;
+}
+
+namespace {
+
+/*
+ * a pointing hint of a block depends on the block and on the rows and
+ * columns crossing it.
+ */
+struct BlockDependencies {
+    unsigned blocks[9];
+
+    BlockDependencies() {
+        for (int block = 0; block < 9; ++block) {
+            int start_row = block / 3 * 3;
+            int start_col = block % 3 * 3;
+            blocks[block] = 1u << (18 + block);
+            for (int i = 0; i < 3; ++i)
+                blocks[block] |= (1u << (start_row + i)) | (1u << (9
+                        + start_col + i));
+        }
+    }
+};
+
+const BlockDependencies BLOCK_DEPENDENCIES;
+
 }
 
 void PointingHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
+    tracker.start(grid, BLOCK_DEPENDENCIES.blocks, 9);
     for (int block_idx = 0; block_idx < 9; ++block_idx) {
-        find_block_hint(block_idx, grid, consumer);
+        if (tracker.is_clean(block_idx))
+            continue;
+        if (!find_block_hint(block_idx, grid, consumer))
+            tracker.set_clean(block_idx);
         if (!consumer.wants_more_hints())
             return;
     }
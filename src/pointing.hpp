@@ -34,6 +34,7 @@
 #define POINTING_HPP_
 
 #include "indirecthint.hpp"
+#include "housetracker.hpp"
 
 class PointingHint: public IndirectHint {
     Grid &grid;
@@ -51,11 +52,17 @@ public:
     const char *get_name() const;
 };
 
+/**
+ * Finds pointing hints. A block searched without result is skipped until
+ * the choices of the block or of its rows and columns change.
+ */
 class PointingHintProducer: public HintProducer {
+private:
+    HouseTracker tracker;
 public:
     void find_hints(Grid &grid, HintConsumer &consumer);
 private:
-    void
+    bool
             find_block_hint(int block_idx, Grid &grid, HintConsumer &consumer) const;
     PointingHint *create_hint(Grid &grid, int start_row, int start_col, int value, int row,
             int col) const;
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "propagation.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct Kernels {
+    bool (*eliminate)(unsigned short *masks, const unsigned short *forbidden,
+            int n);
+    void (*find_single_bits)(const unsigned short *lanes, int n,
+            unsigned *singles);
+    const char *name;
+};
+
+inline bool is_single(unsigned mask) {
+    return mask != 0 && (mask & (mask - 1)) == 0;
+}
+
+bool eliminate_scalar(unsigned short *masks, const unsigned short *forbidden,
+        int n) {
+    unsigned changed = 0;
+    for (int i = 0; i < n; ++i) {
+        changed |= masks[i] & forbidden[i];
+        masks[i] &= ~forbidden[i];
+    }
+    return changed != 0;
+}
+
+void find_single_bits_scalar(const unsigned short *lanes, int n,
+        unsigned *singles) {
+    for (int i = 0; i < (n + 31) / 32; ++i)
+        singles[i] = 0;
+    for (int i = 0; i < n; ++i) {
+        if (is_single(lanes[i]))
+            singles[i >> 5] |= 1u << (i & 31);
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+__attribute__((target("sse2")))
+bool eliminate_sse2(unsigned short *masks, const unsigned short *forbidden,
+        int n) {
+    __m128i changed = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i m = _mm_loadu_si128((const __m128i *) (masks + i));
+        __m128i f = _mm_loadu_si128((const __m128i *) (forbidden + i));
+        changed = _mm_or_si128(changed, _mm_and_si128(m, f));
+        _mm_storeu_si128((__m128i *) (masks + i), _mm_andnot_si128(f, m));
+    }
+    bool result = _mm_movemask_epi8(_mm_cmpeq_epi8(changed,
+            _mm_setzero_si128())) != 0xffff;
+    return eliminate_scalar(masks + i, forbidden + i, n - i) || result;
+}
+
+/*
+ * lanes with exactly one bit: x != 0 and (x & (x - 1)) == 0
+ */
+__attribute__((target("sse2")))
+inline unsigned single_lanes_sse2(__m128i x) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i ones = _mm_set1_epi16(1);
+    __m128i no_rest = _mm_cmpeq_epi16(_mm_and_si128(x, _mm_sub_epi16(x, ones)),
+            zero);
+    __m128i empty = _mm_cmpeq_epi16(x, zero);
+    __m128i single = _mm_andnot_si128(empty, no_rest);
+    return _mm_movemask_epi8(_mm_packs_epi16(single, zero));
+}
+
+__attribute__((target("sse2")))
+void find_single_bits_sse2(const unsigned short *lanes, int n,
+        unsigned *singles) {
+    for (int i = 0; i < (n + 31) / 32; ++i)
+        singles[i] = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (lanes + i));
+        singles[i >> 5] |= single_lanes_sse2(x) << (i & 31);
+    }
+    for (; i < n; ++i) {
+        if (is_single(lanes[i]))
+            singles[i >> 5] |= 1u << (i & 31);
+    }
+}
+
+__attribute__((target("avx2")))
+bool eliminate_avx2(unsigned short *masks, const unsigned short *forbidden,
+        int n) {
+    __m256i changed = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i m = _mm256_loadu_si256((const __m256i *) (masks + i));
+        __m256i f = _mm256_loadu_si256((const __m256i *) (forbidden + i));
+        changed = _mm256_or_si256(changed, _mm256_and_si256(m, f));
+        _mm256_storeu_si256((__m256i *) (masks + i),
+                _mm256_andnot_si256(f, m));
+    }
+    bool result = !_mm256_testz_si256(changed, changed);
+    return eliminate_sse2(masks + i, forbidden + i, n - i) || result;
+}
+
+__attribute__((target("avx2")))
+void find_single_bits_avx2(const unsigned short *lanes, int n,
+        unsigned *singles) {
+    for (int i = 0; i < (n + 31) / 32; ++i)
+        singles[i] = 0;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i ones = _mm256_set1_epi16(1);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (lanes + i));
+        __m256i no_rest = _mm256_cmpeq_epi16(_mm256_and_si256(x,
+                _mm256_sub_epi16(x, ones)), zero);
+        __m256i empty = _mm256_cmpeq_epi16(x, zero);
+        __m256i single = _mm256_andnot_si256(empty, no_rest);
+        /*
+         * packs works within the 128 bit halves: lanes 0..7 end up in
+         * bits 0..7, lanes 8..15 in bits 16..23 of the movemask.
+         */
+        unsigned bits = _mm256_movemask_epi8(_mm256_packs_epi16(single, zero));
+        bits = (bits & 0xff) | ((bits >> 8) & 0xff00);
+        singles[i >> 5] |= bits << (i & 31);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (lanes + i));
+        singles[i >> 5] |= single_lanes_sse2(x) << (i & 31);
+    }
+    for (; i < n; ++i) {
+        if (is_single(lanes[i]))
+            singles[i >> 5] |= 1u << (i & 31);
+    }
+}
+
+#endif
+
+Kernels select_kernels() {
+    Kernels kernels = { eliminate_scalar, find_single_bits_scalar, "scalar" };
+
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.eliminate = eliminate_avx2;
+        kernels.find_single_bits = find_single_bits_avx2;
+        kernels.name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernels.eliminate = eliminate_sse2;
+        kernels.find_single_bits = find_single_bits_sse2;
+        kernels.name = "sse2";
+    }
+#endif
+
+    return kernels;
+}
+
+const Kernels &get_kernels() {
+    static const Kernels kernels = select_kernels();
+    return kernels;
+}
+
+}
+
+bool Propagation::eliminate(unsigned short *masks,
+        const unsigned short *forbidden, int n) {
+    return get_kernels().eliminate(masks, forbidden, n);
+}
+
+void Propagation::find_single_bits(const unsigned short *lanes, int n,
+        unsigned *singles) {
+    get_kernels().find_single_bits(lanes, n, singles);
+}
+
+const char *Propagation::get_implementation() {
+    return get_kernels().name;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROPAGATION_HPP_
+#define PROPAGATION_HPP_
+
+/**
+ * Data parallel kernels of the constraint propagation.
+ *
+ * The kernels work on arrays of 16 bit lanes: the choice masks of the 81
+ * cells or the 27 * 9 house position masks of the grid. Each kernel has a
+ * scalar, an SSE2 and an AVX2 implementation; the best one supported by
+ * the CPU is selected on first use.
+ */
+class Propagation {
+public:
+    /**
+     * removes forbidden[i] from masks[i] for the first n lanes.
+     *
+     * @return true, if at least one mask has changed.
+     */
+    static bool eliminate(unsigned short *masks,
+            const unsigned short *forbidden, int n);
+
+    /**
+     * finds the lanes with exactly one bit set.
+     *
+     * bit i % 32 of singles[i / 32] is set, if lanes[i] has exactly one bit
+     * set. singles must have room for (n + 31) / 32 words.
+     */
+    static void find_single_bits(const unsigned short *lanes, int n,
+            unsigned *singles);
+
+    /**
+     * returns the name of the selected implementation
+     * ("avx2", "sse2" or "scalar").
+     */
+    static const char *get_implementation();
+};
+
+#endif /* PROPAGATION_HPP_ */
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include "puzzlearchive.hpp"
+#include "grid.hpp"
+#include "bitops.hpp"
+
+namespace {
+
+const char MAGIC[4] = { 'S', 'D', 'K', 'A' };
+const int VERSION = 1;
+const int HEADER_SIZE = 32;
+const int MASK_SIZE = 11;
+const int SOLUTION_SIZE = 41;
+const int INDEX_INTERVAL = 32;
+
+unsigned get_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8);
+}
+
+unsigned get_u32(const unsigned char *p) {
+    return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+unsigned long long get_u64(const unsigned char *p) {
+    return get_u32(p) | ((unsigned long long) get_u32(p + 4) << 32);
+}
+
+void put_u16(unsigned char *p, unsigned value) {
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+}
+
+void put_u32(unsigned char *p, unsigned value) {
+    put_u16(p, value & 0xffff);
+    put_u16(p + 2, value >> 16);
+}
+
+void put_u64(unsigned char *p, unsigned long long value) {
+    put_u32(p, static_cast<unsigned> (value & 0xffffffffu));
+    put_u32(p + 4, static_cast<unsigned> (value >> 32));
+}
+
+int digit(char ch) {
+    return ch >= '1' && ch <= '9' ? ch - '0' : 0;
+}
+
+void grid_to_text(const Grid &grid, char *text) {
+    for (int i = 0; i < 81; ++i) {
+        int v = grid[i].get_value();
+        text[i] = v ? '0' + v : '.';
+    }
+}
+
+}
+
+PuzzleArchiveReader::PuzzleArchiveReader() :
+    data(0), index(0), records_end(0), count(0), flags(0),
+            interval(INDEX_INTERVAL) {
+}
+
+bool PuzzleArchiveReader::is_archive(const PuzzleSource &source) {
+    return source.get_size() >= HEADER_SIZE && memcmp(source.get_data(),
+            MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool PuzzleArchiveReader::open(const std::string &filename) {
+    data = 0;
+    index = 0;
+    records_end = 0;
+    count = 0;
+    if (!source.open(filename) || !is_archive(source))
+        return false;
+
+    const unsigned char *header =
+            reinterpret_cast<const unsigned char *> (source.get_data());
+    if (get_u16(header + 4) != VERSION)
+        return false;
+    int n = get_u32(header + 8);
+    int k = get_u32(header + 12);
+    unsigned long long index_offset = get_u64(header + 16);
+    unsigned long long entries = ((unsigned long long) n + k - 1) / k;
+    if (n < 0 || k <= 0 || index_offset < HEADER_SIZE || index_offset
+            > source.get_size() || entries > (source.get_size()
+            - index_offset) / 8)
+        return false;
+
+    /*
+     * the index entries must point into the records in ascending order.
+     */
+    unsigned long long previous = HEADER_SIZE;
+    for (unsigned long long i = 0; i < entries; ++i) {
+        unsigned long long entry = get_u64(header + index_offset + 8 * i);
+        if (entry < previous || entry >= index_offset)
+            return false;
+        previous = entry;
+    }
+
+    data = header;
+    index = header + index_offset;
+    records_end = index_offset;
+    count = n;
+    flags = get_u16(header + 6);
+    interval = k;
+    return true;
+}
+
+bool PuzzleArchiveReader::get_offset(int idx, size_t &offset) const {
+    if (idx < 0 || idx >= count)
+        return false;
+    offset = get_u64(index + 8 * (idx / interval));
+    for (int i = idx - idx % interval; i < idx; ++i) {
+        if (!read(offset, 0))
+            return false;
+    }
+    return true;
+}
+
+bool PuzzleArchiveReader::read(size_t &offset, char *puzzle,
+        char *solution, int *rating) const {
+    if (offset < HEADER_SIZE || offset > records_end || records_end - offset
+            < static_cast<size_t> (MASK_SIZE))
+        return false;
+
+    const unsigned char *mask = data + offset;
+    const unsigned char *digits = mask + MASK_SIZE;
+
+    int givens = 0;
+    for (int i = 0; i < MASK_SIZE; ++i) {
+        givens += count_bits(mask[i]);
+    }
+    if (givens > 81)
+        return false;
+
+    size_t size = MASK_SIZE + (givens + 1) / 2;
+    if (flags & ARCHIVE_SOLUTIONS)
+        size += SOLUTION_SIZE;
+    if (flags & ARCHIVE_RATINGS)
+        size += 2;
+    if (records_end - offset < size)
+        return false;
+
+    if (puzzle) {
+        int k = 0;
+        for (int i = 0; i < 81; ++i) {
+            if (mask[i >> 3] & (1 << (i & 7))) {
+                int v = (digits[k >> 1] >> ((k & 1) * 4)) & 0xf;
+                puzzle[i] = '0' + v;
+                ++k;
+            } else {
+                puzzle[i] = '.';
+            }
+        }
+    }
+
+    const unsigned char *p = digits + (givens + 1) / 2;
+    if (flags & ARCHIVE_SOLUTIONS) {
+        if (solution) {
+            for (int i = 0; i < 81; ++i) {
+                int v = (p[i >> 1] >> ((i & 1) * 4)) & 0xf;
+                solution[i] = v ? '0' + v : '.';
+            }
+        }
+        p += SOLUTION_SIZE;
+    }
+    if (flags & ARCHIVE_RATINGS) {
+        if (rating)
+            *rating = get_u16(p);
+        p += 2;
+    }
+    offset = p - data;
+    return true;
+}
+
+bool PuzzleArchiveReader::get_puzzle(int idx, Grid &grid) const {
+    char puzzle[81];
+    size_t offset;
+    if (!get_offset(idx, offset) || !read(offset, puzzle))
+        return false;
+    grid.load(puzzle, puzzle + 81);
+    return true;
+}
+
+bool PuzzleArchiveReader::get_solution(int idx, Grid &grid) const {
+    if (!has_solutions())
+        return false;
+    char puzzle[81];
+    char solution[81];
+    size_t offset;
+    if (!get_offset(idx, offset) || !read(offset, puzzle, solution))
+        return false;
+    if (memchr(solution, '.', 81))
+        return false;
+    grid.load(solution, solution + 81);
+    return true;
+}
+
+bool PuzzleArchiveReader::get_rating(int idx, int &rating) const {
+    size_t offset;
+    return has_ratings() && get_offset(idx, offset) && read(offset, 0, 0,
+            &rating);
+}
+
+PuzzleArchiveWriter::PuzzleArchiveWriter() :
+    flags(0), count(0), offset(0) {
+}
+
+PuzzleArchiveWriter::~PuzzleArchiveWriter() {
+    if (out.is_open())
+        close();
+}
+
+bool PuzzleArchiveWriter::open(const std::string &filename, int flags) {
+    out.open(filename.c_str(), std::ios::out | std::ios::binary
+            | std::ios::trunc);
+    if (!out)
+        return false;
+
+    this->flags = flags;
+    count = 0;
+    index.clear();
+
+    /*
+     * the header is rewritten by close() when the number of
+     * puzzles and the index offset are known.
+     */
+    char header[HEADER_SIZE] = { 0 };
+    out.write(header, HEADER_SIZE);
+    offset = HEADER_SIZE;
+    return true;
+}
+
+void PuzzleArchiveWriter::add(const char *puzzle, const char *solution,
+        int rating) {
+    unsigned char record[MASK_SIZE + (81 + 1) / 2 + SOLUTION_SIZE + 2] = { 0 };
+    unsigned char *digits = record + MASK_SIZE;
+    int givens = 0;
+
+    for (int i = 0; i < 81; ++i) {
+        int v = digit(puzzle[i]);
+        if (v) {
+            record[i >> 3] |= 1 << (i & 7);
+            digits[givens >> 1] |= v << ((givens & 1) * 4);
+            ++givens;
+        }
+    }
+
+    unsigned char *p = digits + (givens + 1) / 2;
+    if (flags & ARCHIVE_SOLUTIONS) {
+        if (solution) {
+            for (int i = 0; i < 81; ++i) {
+                p[i >> 1] |= digit(solution[i]) << ((i & 1) * 4);
+            }
+        }
+        p += SOLUTION_SIZE;
+    }
+    if (flags & ARCHIVE_RATINGS) {
+        put_u16(p, rating < 0 ? 0 : rating > 0xffff ? 0xffff : rating);
+        p += 2;
+    }
+
+    if (count % INDEX_INTERVAL == 0)
+        index.push_back(offset);
+    out.write(reinterpret_cast<const char *> (record), p - record);
+    offset += p - record;
+    ++count;
+}
+
+void PuzzleArchiveWriter::add(const Grid &puzzle, const Grid *solution,
+        int rating) {
+    char text[81];
+    char solution_text[81];
+
+    grid_to_text(puzzle, text);
+    if (solution)
+        grid_to_text(*solution, solution_text);
+    add(text, solution ? solution_text : 0, rating);
+}
+
+bool PuzzleArchiveWriter::close() {
+    std::vector<unsigned char> buffer(8 * index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        put_u64(&buffer[8 * i], index[i]);
+    }
+    if (!buffer.empty())
+        out.write(reinterpret_cast<const char *> (&buffer[0]), buffer.size());
+
+    unsigned char header[HEADER_SIZE] = { 0 };
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    put_u16(header + 4, VERSION);
+    put_u16(header + 6, flags);
+    put_u32(header + 8, count);
+    put_u32(header + 12, INDEX_INTERVAL);
+    put_u64(header + 16, offset);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *> (header), HEADER_SIZE);
+
+    bool result = out.good();
+    out.close();
+    return result;
+}
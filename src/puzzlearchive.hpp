@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PUZZLEARCHIVE_HPP_
+#define PUZZLEARCHIVE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "puzzlesource.hpp"
+
+class Grid;
+
+/**
+ * optional blocks of a puzzle archive.
+ */
+enum ArchiveFlags {
+    ARCHIVE_SOLUTIONS = 1, ARCHIVE_RATINGS = 2
+};
+
+/**
+ * Reads a binary puzzle archive.
+ *
+ * An archive (all numbers little endian) consists of
+ *
+ * - a 32 byte header: the magic "SDKA", a 16 bit version, 16 bit flags,
+ *   the 32 bit number of puzzles, the 32 bit index interval and the 64 bit
+ *   offset of the index.
+ * - the records. each record holds an 81 bit clue mask (11 bytes, cell 0
+ *   in the lowest bit), the digits of the givens packed into 4 bits each,
+ *   optionally the 81 digits of the solution (41 bytes, 0 = unknown) and
+ *   optionally a 16 bit rating.
+ * - the index: the 64 bit offset of every interval-th record.
+ *
+ * A record is located by its nearest index entry and skipping less than
+ * interval records, so access by index takes constant time.
+ *
+ * The index is checked when the archive is opened, each record is checked
+ * against the end of the records before it is decoded. A damaged archive
+ * makes the access methods return false instead of reading past the
+ * mapped file.
+ */
+class PuzzleArchiveReader {
+private:
+    PuzzleSource source;
+    const unsigned char *data;
+    const unsigned char *index;
+    size_t records_end;
+    int count;
+    int flags;
+    int interval;
+public:
+    PuzzleArchiveReader();
+    /*! \brief opens an archive, returns false if it is missing or invalid */
+    bool open(const std::string &filename);
+    int get_count() const;
+    bool has_solutions() const;
+    bool has_ratings() const;
+    /**
+     * finds the file offset of a record.
+     *
+     * @param index the index of the record
+     * @param offset receives the offset of the record
+     * @return false if there is no such record or the archive is damaged
+     */
+    bool get_offset(int index, size_t &offset) const;
+    /**
+     * decodes the record at offset.
+     *
+     * @param offset the offset of a record, receives the offset of the next record
+     * @param puzzle receives 81 characters in the text format ('.' for empty cells)
+     * @param solution if not 0 receives the 81 characters of the solution
+     * @param rating if not 0 receives the rating
+     * @return false if the record does not fit into the archive
+     */
+    bool read(size_t &offset, char *puzzle, char *solution = 0,
+            int *rating = 0) const;
+    /*! \brief returns false if there is no such puzzle */
+    bool get_puzzle(int index, Grid &grid) const;
+    /*! \brief returns false if the archive contains no solution for the puzzle */
+    bool get_solution(int index, Grid &grid) const;
+    /*! \brief returns false if the archive contains no rating for the puzzle */
+    bool get_rating(int index, int &rating) const;
+    /*! \brief returns true if the file starts with the archive magic */
+    static bool is_archive(const PuzzleSource &source);
+private:
+    PuzzleArchiveReader(const PuzzleArchiveReader &other) {
+    }
+    PuzzleArchiveReader &operator =(const PuzzleArchiveReader &other) {
+        return *this;
+    }
+};
+
+/**
+ * Writes a binary puzzle archive, see PuzzleArchiveReader for the format.
+ *
+ * The records are written as they are added, the index and the final
+ * header are written by close().
+ */
+class PuzzleArchiveWriter {
+private:
+    std::ofstream out;
+    int flags;
+    int count;
+    unsigned long long offset;
+    std::vector<unsigned long long> index;
+public:
+    PuzzleArchiveWriter();
+    ~PuzzleArchiveWriter();
+    /**
+     * creates an archive.
+     *
+     * @param filename the name of the archive
+     * @param flags the optional blocks to store (ArchiveFlags)
+     */
+    bool open(const std::string &filename, int flags);
+    /**
+     * adds a puzzle given in the text format.
+     *
+     * @param puzzle 81 characters, digits 1..9 are givens
+     * @param solution 81 characters or 0
+     * @param rating the rating, only stored if the archive has ratings
+     */
+    void add(const char *puzzle, const char *solution = 0, int rating = 0);
+    void add(const Grid &puzzle, const Grid *solution = 0, int rating = 0);
+    /*! \brief writes the index and the header, returns false on errors */
+    bool close();
+private:
+    PuzzleArchiveWriter(const PuzzleArchiveWriter &other) {
+    }
+    PuzzleArchiveWriter &operator =(const PuzzleArchiveWriter &other) {
+        return *this;
+    }
+};
+
+inline int PuzzleArchiveReader::get_count() const {
+    return count;
+}
+
+inline bool PuzzleArchiveReader::has_solutions() const {
+    return (flags & ARCHIVE_SOLUTIONS) != 0;
+}
+
+inline bool PuzzleArchiveReader::has_ratings() const {
+    return (flags & ARCHIVE_RATINGS) != 0;
+}
+
+#endif /* PUZZLEARCHIVE_HPP_ */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "puzzlesource.hpp"
+
+PuzzleSource::PuzzleSource() :
+    data(0), size(0), mapped(false) {
+}
+
+PuzzleSource::~PuzzleSource() {
+    close();
+}
+
+bool PuzzleSource::open(const std::string &filename) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            data = static_cast<const char *> (p);
+            size = st.st_size;
+            mapped = true;
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    /*
+     * empty files and files which cannot be mapped (pipes, ...)
+     * are read into a buffer.
+     */
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+        return false;
+    char chunk[65536];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+        buffer.insert(buffer.end(), chunk, chunk + in.gcount());
+    }
+    data = buffer.empty() ? 0 : &buffer[0];
+    size = buffer.size();
+    return true;
+}
+
+void PuzzleSource::close() {
+#ifndef _WIN32
+    if (mapped)
+        munmap(const_cast<char *> (data), size);
+#endif
+    buffer.clear();
+    data = 0;
+    size = 0;
+    mapped = false;
+}
+
+size_t PuzzleSource::align(size_t offset) const {
+    if (offset == 0 || offset >= size)
+        return offset < size ? offset : size;
+    if (data[offset - 1] == '\n')
+        return offset;
+    const void *eol = memchr(data + offset, '\n', size - offset);
+    if (!eol)
+        return size;
+    return static_cast<const char *> (eol) - data + 1;
+}
+
+void PuzzleSource::split(int parts, std::vector<size_t> &offsets) const {
+    offsets.resize(parts + 1);
+    for (int i = 0; i < parts; ++i) {
+        offsets[i] = align(size / parts * i);
+    }
+    offsets[parts] = size;
+}
+
+PuzzleReader::PuzzleReader(const PuzzleSource &source, size_t begin,
+        size_t end) :
+    current(source.get_data() + begin), end(source.get_data() + end) {
+}
+
+bool PuzzleReader::next(const char *&line, const char *&line_end) {
+    while (current != end) {
+        const char *eol = static_cast<const char *> (memchr(current, '\n',
+                end - current));
+        line = current;
+        line_end = eol ? eol : end;
+        current = eol ? eol + 1 : end;
+        if (line_end != line && line_end[-1] == '\r')
+            --line_end;
+        if (line_end != line)
+            return true;
+    }
+    return false;
+}
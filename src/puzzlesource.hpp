@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PUZZLESOURCE_HPP_
+#define PUZZLESOURCE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * A read only view of a puzzle file.
+ *
+ * The file is mapped into memory, so the puzzles can be parsed in place
+ * without copying them into strings. Where memory mapping is not available
+ * the file is read into a buffer instead.
+ *
+ * A puzzle file contains one puzzle per line. The file can be split into
+ * parts at byte offsets, see align(), so that several threads can read
+ * disjoint lines of the same file.
+ */
+class PuzzleSource {
+private:
+    const char *data;
+    size_t size;
+    bool mapped;
+    std::vector<char> buffer;
+public:
+    PuzzleSource();
+    ~PuzzleSource();
+    /*! \brief maps a file, returns false if it cannot be opened */
+    bool open(const std::string &filename);
+    void close();
+    const char *get_data() const;
+    size_t get_size() const;
+    /**
+     * returns the offset of the first line starting at or after offset.
+     *
+     * @param offset a byte offset in the file
+     * @return the start of a line or the size of the file
+     */
+    size_t align(size_t offset) const;
+    /**
+     * splits the file into parts of about equal size.
+     *
+     * @param parts the number of parts
+     * @param offsets receives parts + 1 line aligned offsets, part i
+     * consists of the lines starting in [offsets[i], offsets[i + 1]).
+     */
+    void split(int parts, std::vector<size_t> &offsets) const;
+private:
+    PuzzleSource(const PuzzleSource &other) {
+    }
+    PuzzleSource &operator =(const PuzzleSource &other) {
+        return *this;
+    }
+};
+
+/**
+ * Iterates over the lines of a part of a PuzzleSource.
+ *
+ * Empty lines are skipped, trailing carriage returns are removed.
+ */
+class PuzzleReader {
+private:
+    const char *current;
+    const char *end;
+public:
+    /**
+     * @param source the puzzle file
+     * @param begin the offset of the first line
+     * @param end the offset behind the last line
+     */
+    PuzzleReader(const PuzzleSource &source, size_t begin, size_t end);
+    /*! \brief returns the next line as [line, line_end), false at the end */
+    bool next(const char *&line, const char *&line_end);
+};
+
+inline const char *PuzzleSource::get_data() const {
+    return data;
+}
+
+inline size_t PuzzleSource::get_size() const {
+    return size;
+}
+
+#endif /* PUZZLESOURCE_HPP_ */
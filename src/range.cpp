@@ -32,93 +32,54 @@
 
 #include "range.hpp"
 #include <sstream>
-#include <set>
 
-const RangeList RANGES;
+std::string Range::get_name() const {
+    std::ostringstream os;
 
-RangeList::RangeList() {
-    int indexes[9];
-
-    for (int row = 0; row < 9; ++row) {
-        std::ostringstream os;
-        os << "row " << row + 1;
-        for (int col = 0; col < 9; ++col) {
-            indexes[col] = row * 9 + col;
-        }
-        ranges.push_back(Range(os.str(), indexes));
-        rows.push_back(Range(os.str(), indexes));
+    if (house < 9) {
+        os << "row " << house + 1;
+    } else if (house < 18) {
+        os << "col " << house - 9 + 1;
+    } else {
+        int block = house - 18;
+        os << "block(" << block / 3 + 1 << ',' << block % 3 + 1 << ')';
     }
 
-    for (int col = 0; col < 9; ++col) {
-        std::ostringstream os;
-        os << "col " << col + 1;
-        for (int row = 0; row < 9; ++row) {
-            indexes[row] = row * 9 + col;
-        }
-        ranges.push_back(Range(os.str(), indexes));
-        columns.push_back(Range(os.str(), indexes));
-    }
-
-    for (int i = 0; i < 3; ++i) {
-        int start_row = 3 * i;
+    return os.str();
+}
 
-        for (int j = 0; j < 3; ++j) {
-            int start_col = 3 * j;
-            std::ostringstream os;
-            os << "block(" << i + 1 << ',' << j + 1 << ')';
+constexpr RangeList::RangeList() :
+    ranges(), field_houses(), field_neighbours() {
+    for (int row = 0; row < 9; ++row) {
+        for (int col = 0; col < 9; ++col) {
+            int idx = row * 9 + col;
+            int block = row / 3 * 3 + col / 3;
+            int pos = row % 3 * 3 + col % 3;
 
-            int idx = 0;
-            for (int row = start_row; row < start_row + 3; ++row) {
-                for (int col = start_col; col < start_col + 3; ++col) {
-                    indexes[idx] = row * 9 + col;
-                    ++idx;
-                }
-            }
+            ranges[row].indexes[col] = idx;
+            ranges[9 + col].indexes[row] = idx;
+            ranges[18 + block].indexes[pos] = idx;
 
-            ranges.push_back(Range(os.str(), indexes));
-            blocks.push_back(Range(os.str(), indexes));
+            field_houses[idx][0] = row;
+            field_houses[idx][1] = 9 + col;
+            field_houses[idx][2] = 18 + block;
         }
     }
 
-    field_ranges.resize(81);
-    for (const_iterator i = begin(); i != end(); ++i) {
-        for (Range::const_iterator j = i->begin(); j != i->end(); ++j) {
-            field_ranges[*j].push_back(*i);
-        }
+    for (int house = 0; house < NUM_RANGES; ++house) {
+        ranges[house].house = house;
     }
 
-    field_neighbours.resize(81);
     for (int idx = 0; idx < 81; ++idx) {
-        const_iterator begin = field_ranges[idx].begin();
-        const_iterator end = field_ranges[idx].end();
-        std::set<int> neighbours;
-        for (const_iterator irange = begin; irange != end; ++irange) {
-            for (Range::const_iterator j = irange->begin(); j != irange->end(); ++j) {
-                if (*j != idx) {
-                    neighbours.insert(*j);
-                }
+        int n = 0;
+        for (int other = 0; other < 81; ++other) {
+            if (other != idx && (other / 9 == idx / 9 || other % 9 == idx % 9
+                    || (other / 27 == idx / 27 && other % 9 / 3 == idx % 9 / 3))) {
+                field_neighbours[idx][n] = other;
+                ++n;
             }
         }
-        std::copy(neighbours.begin(), neighbours.end(), std::back_inserter(
-                field_neighbours[idx]));
     }
 }
 
-RangeList::RangeList(const RangeList &other) :
-    ranges(other.ranges), field_neighbours(other.field_neighbours), rows(other.rows),
-            columns(other.columns), blocks(other.blocks) {
-}
-
-RangeList &RangeList::operator =(const RangeList &other) {
-    if (this == &other)
-        return *this;
-
-    ranges = other.ranges;
-    rows = other.rows;
-    columns = other.columns;
-    blocks = other.blocks;
-    field_neighbours = other.field_neighbours;
-
-    return *this;
-}
-
+constexpr RangeList RANGES;
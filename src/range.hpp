@@ -34,90 +34,74 @@
 #define RANGE_HPP_
 
 #include <string>
-#include <vector>
 
+/**
+ * One of the 27 houses of the grid. Houses 0-8 are the rows, 9-17 the
+ * columns and 18-26 the blocks (numbered row by row). A range is a literal
+ * type, so the complete table is built at compile time.
+ */
 class Range {
 public:
     typedef const int *const_iterator;
-public:
-    std::string name;
+private:
+    /*
+     * the members are filled in by the constexpr constructor of RangeList.
+     */
+    friend class RangeList;
+
+    int house;
     int indexes[9];
 public:
-    Range(const std::string &name, int indexes[9]);
-    Range(const Range &other);
-    Range & operator =(const Range &other);
     int operator[](int idx) const;
-    int &operator[](int idx);
     const_iterator begin() const;
     const_iterator end() const;
-    const std::string &get_name() const;
+    int get_house() const;
+    std::string get_name() const;
     bool is_in_range(int idx) const;
 };
 
+/**
+ * Compile time tables describing the houses, the three houses of each cell
+ * and the 20 peers of each cell (in ascending order).
+ */
 class RangeList {
 public:
-    typedef std::vector<Range>::iterator iterator;
-    typedef std::vector<Range>::const_iterator const_iterator;
-    typedef std::vector<int>::const_iterator const_index_iterator;
+    typedef const Range *iterator;
+    typedef const Range *const_iterator;
+    typedef const unsigned char *const_index_iterator;
+    enum {
+        NUM_RANGES = 27, NUM_PEERS = 20
+    };
 private:
-    std::vector<Range> ranges;
-    std::vector<std::vector<Range> > field_ranges;
-    std::vector<std::vector<int> > field_neighbours;
-    std::vector<Range> rows;
-    std::vector<Range> columns;
-    std::vector<Range> blocks;
+    Range ranges[NUM_RANGES];
+    unsigned char field_houses[81][3];
+    unsigned char field_neighbours[81][NUM_PEERS];
 public:
-    RangeList();
-    RangeList(const RangeList &other);
-    RangeList & operator =(const RangeList &other);
-    iterator begin();
-    iterator end();
+    constexpr RangeList();
     const_iterator begin() const;
     const_iterator end() const;
 
     const_index_iterator field_begin(int idx) const;
     const_index_iterator field_end(int idx) const;
 
+    const Range &get_range(int house) const;
     const Range &get_row(int row) const;
     const Range &get_column(int col) const;
     const Range &get_block(int block) const;
-    const std::vector<Range> &get_field_ranges(int idx) const;
+    /*! \brief returns the row (i == 0), column (i == 1) or block (i == 2) of the cell */
+    const Range &get_field_range(int idx, int i) const;
 
-    const std::vector<Range> &get_rows() const;
-    const std::vector<Range> &get_columns() const;
-    const std::vector<Range> &get_blocks() const;
+    const Range *get_rows() const;
+    const Range *get_columns() const;
+    const Range *get_blocks() const;
 };
 
 extern const RangeList RANGES;
 
-inline Range::Range(const std::string &name, int indexes[9]) :
-    name(name) {
-    std::copy(indexes, indexes + 9, this->indexes);
-}
-
-inline Range::Range(const Range &other) :
-    name(other.name) {
-
-    std::copy(other.indexes, other.indexes + 9, indexes);
-}
-
-inline Range &Range::operator =(const Range &other) {
-    if (this == &other)
-        return *this;
-
-    std::copy(other.indexes, other.indexes + 9, indexes);
-
-    return *this;
-}
-
 inline int Range::operator[](int idx) const {
     return indexes[idx];
 }
 
-inline int &Range::operator[](int idx) {
-    return indexes[idx];
-}
-
 inline Range::const_iterator Range::begin() const {
     return indexes;
 }
@@ -126,8 +110,8 @@ inline Range::const_iterator Range::end() const {
     return indexes + 9;
 }
 
-inline const std::string &Range::get_name() const {
-    return name;
+inline int Range::get_house() const {
+    return house;
 }
 
 inline bool Range::is_in_range(int idx) const {
@@ -138,56 +122,52 @@ inline bool Range::is_in_range(int idx) const {
     return false;
 }
 
-inline RangeList::iterator RangeList::begin() {
-    return ranges.begin();
-}
-
-inline RangeList::iterator RangeList::end() {
-    return ranges.end();
-}
-
 inline RangeList::const_iterator RangeList::begin() const {
-    return ranges.begin();
+    return ranges;
 }
 
 inline RangeList::const_iterator RangeList::end() const {
-    return ranges.end();
+    return ranges + NUM_RANGES;
 }
 
 inline RangeList::const_index_iterator RangeList::field_begin(int idx) const {
-    return field_neighbours[idx].begin();
+    return field_neighbours[idx];
 }
 
 inline RangeList::const_index_iterator RangeList::field_end(int idx) const {
-    return field_neighbours[idx].end();
+    return field_neighbours[idx] + NUM_PEERS;
+}
+
+inline const Range &RangeList::get_range(int house) const {
+    return ranges[house];
 }
 
 inline const Range &RangeList::get_row(int row) const {
-    return rows[row];
+    return ranges[row];
 }
 
 inline const Range &RangeList::get_column(int col) const {
-    return columns[col];
+    return ranges[9 + col];
 }
 
 inline const Range &RangeList::get_block(int block) const {
-    return blocks[block];
+    return ranges[18 + block];
 }
 
-inline const std::vector<Range> &RangeList::get_field_ranges(int idx) const {
-    return field_ranges[idx];
+inline const Range &RangeList::get_field_range(int idx, int i) const {
+    return ranges[field_houses[idx][i]];
 }
 
-inline const std::vector<Range> &RangeList::get_rows() const {
-    return rows;
+inline const Range *RangeList::get_rows() const {
+    return ranges;
 }
 
-inline const std::vector<Range> &RangeList::get_columns() const {
-    return columns;
+inline const Range *RangeList::get_columns() const {
+    return ranges + 9;
 }
 
-inline const std::vector<Range> &RangeList::get_blocks() const {
-    return blocks;
+inline const Range *RangeList::get_blocks() const {
+    return ranges + 18;
 }
 
 #endif /* RANGE_HPP_ */
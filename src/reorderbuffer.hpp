@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REORDERBUFFER_HPP_
+#define REORDERBUFFER_HPP_
+
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Collects results which are produced out of order by several threads and
+ * hands them out in the order of their indexes (0, 1, 2, ...).
+ *
+ * Each producing thread calls finish() when it is done; take() fails once
+ * all producers have finished and no result is left.
+ *
+ * At most capacity results ahead of the next one are buffered: put() waits
+ * until the consumer has caught up, so one slow result cannot make the
+ * buffer grow with the size of the input.
+ */
+template<class T>
+class ReorderBuffer {
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<int, T> results;
+    int next;
+    int producers;
+    int capacity;
+public:
+    ReorderBuffer(int producers, int capacity);
+    void put(int index, const T &result);
+    void finish();
+    /*! \brief waits for the next result in order, returns false if there is none */
+    bool take(T &result);
+private:
+    ReorderBuffer(const ReorderBuffer &other) {
+    }
+    ReorderBuffer &operator =(const ReorderBuffer &other) {
+        return *this;
+    }
+};
+
+template<class T>
+inline ReorderBuffer<T>::ReorderBuffer(int producers, int capacity) :
+    next(0), producers(producers), capacity(capacity) {
+}
+
+template<class T>
+inline void ReorderBuffer<T>::put(int index, const T &result) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (index >= next + capacity)
+        changed.wait(lock);
+    results[index] = result;
+    if (index == next)
+        changed.notify_all();
+}
+
+template<class T>
+inline void ReorderBuffer<T>::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    --producers;
+    changed.notify_all();
+}
+
+template<class T>
+inline bool ReorderBuffer<T>::take(T &result) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        typename std::map<int, T>::iterator i = results.find(next);
+        if (i != results.end()) {
+            result = i->second;
+            results.erase(i);
+            ++next;
+            changed.notify_all();
+            return true;
+        }
+        if (producers == 0)
+            return false;
+        changed.wait(lock);
+    }
+}
+
+#endif /* REORDERBUFFER_HPP_ */
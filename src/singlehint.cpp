@@ -35,6 +35,7 @@
 #include "range.hpp"
 #include "hintconsumer.hpp"
 #include "util.hpp"
+#include "propagation.hpp"
 
 #include <iostream>
 
@@ -44,10 +45,15 @@ SingleHint::SingleHint(int cell_idx, int value, const Range &range) :
 
 void SingleHint::apply(Grid &grid) {
     Cell &cell = grid[cell_idx];
-    cell.set_value(value);
+    grid.set_cell_value(cell, value);
     grid.cleanup_choice(cell);
 }
 
+bool SingleHint::is_applicable(const Grid &grid) const {
+    const Cell &cell = grid[cell_idx];
+    return !cell.has_value() && cell.has_choice(value);
+}
+
 void SingleHint::print_description(std::ostream &out) const {
     out << "single: cell: " << print_row_col(cell_idx) << " value: " << value
             << " range: " << range.get_name();
@@ -58,27 +64,29 @@ const char *SingleHint::get_name() const {
 }
 
 void SingleHintProducer::find_hints(Grid & grid, HintConsumer & consumer) {
+    unsigned singles[8];
 
-    for (RangeList::const_iterator irange = RANGES.begin(); irange
-            != RANGES.end(); ++irange) {
-        std::vector<std::vector<Cell *> > frequencies(10);
-        for (Range::const_iterator i = irange->begin(); i != irange->end(); ++i) {
-            Cell &cell = grid[*i];
-            if (cell.has_value())
-                continue;
-            for (int value = 1; value < 10; ++value) {
-                if (cell.has_choice(value)) {
-                    frequencies[value].push_back(&cell);
-                }
-            }
-        }
+    /*
+     * lane house * 9 + value - 1 is single, if value has only one
+     * position left in house.
+     */
+    Propagation::find_single_bits(grid.get_house_positions(), 27 * 9, singles);
 
-        for (int value = 1; value < 10; ++value) {
-            if (frequencies[value].size() == 1) {
-                if (!consumer.consume_hint(new SingleHint(
-                        frequencies[value][0]->get_idx(), value, *irange))) {
-                    return;
-                }
+    for (int word = 0; word < 8; ++word) {
+        for (unsigned bits = singles[word]; bits != 0; bits &= bits - 1) {
+            int lane = 32 * word + first_bit(bits);
+            int house = lane / 9;
+            int value = lane % 9 + 1;
+            /*
+             * the consumer may have changed the grid in the meantime
+             */
+            unsigned int positions = grid.get_house_positions(house, value);
+            if (count_bits(positions) != 1)
+                continue;
+            const Range &range = RANGES.get_range(house);
+            int idx = range[first_bit(positions)];
+            if (!consumer.consume_hint(new SingleHint(idx, value, range))) {
+                return;
             }
         }
     }
@@ -47,6 +47,7 @@ public:
     SingleHint(int cell_idx, int value, const Range &range);
 
     virtual void apply(Grid &grid);
+    virtual bool is_applicable(const Grid &grid) const;
     virtual void print_description(std::ostream &out) const;
     const char *get_name() const;
 };
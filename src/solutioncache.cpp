@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include "solutioncache.hpp"
+
+namespace {
+
+/*
+ * returns true if s holds the 81 cells of a grid, '.' or '0'..'9' each.
+ */
+bool is_grid(const std::string &s) {
+    if (s.size() != 81)
+        return false;
+    for (std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
+        if (*i != '.' && (*i < '0' || *i > '9'))
+            return false;
+    }
+    return true;
+}
+
+}
+
+CacheEntry::CacheEntry() :
+    solutions(UNKNOWN), rating(UNKNOWN), rating_exact(false) {
+}
+
+SolutionCache::SolutionCache(size_t capacity) :
+    capacity(capacity > 0 ? capacity : 1), hits(0), misses(0) {
+}
+
+std::string SolutionCache::make_key(const unsigned char *canonical) {
+    std::string key(81, '0');
+    for (int i = 0; i < 81; ++i) {
+        key[i] = '0' + canonical[i];
+    }
+    return key;
+}
+
+bool SolutionCache::lookup(const std::string &key, CacheEntry &entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    EntryMap::iterator i = index.find(key);
+    if (i == index.end()) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    entries.splice(entries.begin(), entries, i->second);
+    entry = i->second->second;
+    return true;
+}
+
+void SolutionCache::store(const std::string &key, const CacheEntry &entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(key, entry);
+}
+
+void SolutionCache::insert(const std::string &key, const CacheEntry &entry) {
+    EntryMap::iterator i = index.find(key);
+    if (i == index.end()) {
+        entries.push_front(std::make_pair(key, entry));
+        index[key] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return;
+    }
+
+    entries.splice(entries.begin(), entries, i->second);
+    CacheEntry &known = i->second->second;
+    if (entry.solutions != CacheEntry::UNKNOWN)
+        known.solutions = entry.solutions;
+    if (entry.rating != CacheEntry::UNKNOWN && !known.rating_exact
+            && (entry.rating_exact || entry.rating > known.rating)) {
+        known.rating = entry.rating;
+        known.rating_exact = entry.rating_exact;
+    }
+    if (!entry.solution.empty())
+        known.solution = entry.solution;
+}
+
+size_t SolutionCache::get_size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+long SolutionCache::get_hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+long SolutionCache::get_misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+/*
+ * the file contains one entry per line: the canonical form, the number of
+ * solutions, the rating, 1 if the rating is exact and the solution ('-' if
+ * unknown). the least recently used entries come first. lines whose
+ * canonical form or solution is not a grid are skipped.
+ */
+bool SolutionCache::load(const std::string &filename) {
+    std::ifstream in(filename.c_str());
+    if (!in)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    while (getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        std::string solution;
+        CacheEntry entry;
+        if (!(fields >> key >> entry.solutions >> entry.rating
+                >> entry.rating_exact >> solution) || !is_grid(key)
+                || (solution != "-" && !is_grid(solution)))
+            continue;
+        if (solution != "-")
+            entry.solution = solution;
+        insert(key, entry);
+    }
+    return true;
+}
+
+bool SolutionCache::save(const std::string &filename) const {
+    std::ofstream out(filename.c_str());
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (EntryList::const_reverse_iterator i = entries.rbegin(); i
+            != entries.rend(); ++i) {
+        const CacheEntry &entry = i->second;
+        out << i->first << ' ' << entry.solutions << ' ' << entry.rating
+                << ' ' << entry.rating_exact << ' ' << (entry.solution.empty()
+                ? "-" : entry.solution) << '\n';
+    }
+    return out.good();
+}
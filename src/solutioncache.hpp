@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SOLUTIONCACHE_HPP_
+#define SOLUTIONCACHE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+/**
+ * What is known about a puzzle. Everything is stored for the canonical
+ * form of the puzzle (see Canonicalizer), so it applies to all puzzles
+ * which are transformations of each other.
+ */
+struct CacheEntry {
+    enum {
+        UNKNOWN = -1, TOO_HARD = 0x7fff
+    };
+    /*! \brief number of solutions: 0, 1, 2 (= more than one) or UNKNOWN */
+    int solutions;
+    /*! \brief the index of the hardest hint producer needed, TOO_HARD or UNKNOWN */
+    int rating;
+    /*! \brief false if rating is only a lower bound */
+    bool rating_exact;
+    /*! \brief the 81 digits of a solution of the canonical form or empty */
+    std::string solution;
+
+    CacheEntry();
+};
+
+/**
+ * A bounded, thread safe cache of solutions, solution counts and ratings
+ * keyed by canonical puzzle forms.
+ *
+ * When the cache is full the least recently used entry is dropped. The
+ * cache can be saved to a text file and loaded again in a later run.
+ */
+class SolutionCache {
+private:
+    typedef std::list<std::pair<std::string, CacheEntry> > EntryList;
+    typedef std::unordered_map<std::string, EntryList::iterator> EntryMap;
+    mutable std::mutex mutex;
+    EntryList entries;
+    EntryMap index;
+    size_t capacity;
+    long hits;
+    long misses;
+public:
+    SolutionCache(size_t capacity = 1 << 20);
+    /**
+     * returns the key of a canonical form.
+     *
+     * @param canonical the 81 digits of the canonical form (0 = empty)
+     */
+    static std::string make_key(const unsigned char *canonical);
+    /*! \brief looks up a puzzle and marks it as recently used */
+    bool lookup(const std::string &key, CacheEntry &entry);
+    /*! \brief stores what is known about a puzzle, known fields of an existing entry are kept */
+    void store(const std::string &key, const CacheEntry &entry);
+    size_t get_size() const;
+    long get_hits() const;
+    long get_misses() const;
+    /*! \brief adds the entries of a file, returns false if it cannot be read */
+    bool load(const std::string &filename);
+    /*! \brief writes all entries to a file, returns false on errors */
+    bool save(const std::string &filename) const;
+private:
+    void insert(const std::string &key, const CacheEntry &entry);
+    SolutionCache(const SolutionCache &other) {
+    }
+    SolutionCache &operator =(const SolutionCache &other) {
+        return *this;
+    }
+};
+
+#endif /* SOLUTIONCACHE_HPP_ */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2009, Ralph Juhnke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *    * Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    * Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *    * Neither the name of "Ralph Juhnke" nor the names of its
+ *      contributors may be used to endorse or promote products derived from
+ *      this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SOLVERENGINE_HPP_
+#define SOLVERENGINE_HPP_
+
+#include "solutioncount.hpp"
+
+class Grid;
+
+enum EngineType {
+    ENGINE_DLX, ENGINE_BITBOARD
+};
+
+/**
+ * Common interface of the brute force solvers.
+ *
+ * The candidates of the empty cells of the grid are taken into account:
+ * a value that has been removed from a cell is never tried there.
+ */
+class SolverEngine {
+public:
+    virtual ~SolverEngine();
+    /*!
+     * \brief counts up to limit solutions, limit <= 0 counts all
+     *
+     * max_nodes and max_seconds bound the search (<= 0 means no bound). If
+     * the budget runs out, the count is incomplete and budget_exhausted is set.
+     * max_seconds is wall clock time measured from the start of this call.
+     */
+    virtual SolutionCount count_solutions(const Grid &grid, int limit,
+            long max_nodes = 0, double max_seconds = 0) = 0;
+    /*!
+     * \brief stores the first solution in solution
+     *
+     * the solution is valid if the count is 1. a count of 0 means there is
+     * no solution, unless budget_exhausted is set.
+     */
+    virtual SolutionCount find_first(const Grid &grid, Grid &solution,
+            long max_nodes = 0, double max_seconds = 0) = 0;
+    virtual bool is_unique(const Grid &grid) = 0;
+};
+
+/*! \brief creates a solver of the given type, the caller owns the result */
+SolverEngine *create_solver_engine(EngineType type);
+
+#endif /* SOLVERENGINE_HPP_ */
@@ -34,8 +34,10 @@
 #include <string>
 #include <vector>
 #include <sstream>
-#include <fstream>
 #include <ctime>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
 
 #include "util.hpp"
 #include "range.hpp"
@@ -54,12 +56,12 @@
 #include "swordfish.hpp"
 #include "xywing.hpp"
 #include "nakedsingle.hpp"
+#include "blockingqueue.hpp"
+#include "puzzlesource.hpp"
+#include "sudokusolver.hpp"
+#include "reorderbuffer.hpp"
 
-bool solve(const std::string &s) {
-    std::istringstream in(s);
-    Grid grid;
-    std::vector<HintProducer *> hintproducers;
-
+void create_hint_producers(std::vector<HintProducer *> &hintproducers) {
     hintproducers.push_back(new NakedSingleHintProducer());
     hintproducers.push_back(new SingleHintProducer());
     hintproducers.push_back(new NakedDoubleHintProducer());
@@ -73,66 +75,243 @@ bool solve(const std::string &s) {
     hintproducers.push_back(new SwordfishHintProducer());
     hintproducers.push_back(new ForcingChainHintProducer());
     //     hintproducers.push_back(new SimpleForcingChainHintProducer());
+}
 
-    grid.load(in);
-    grid.print(std::cout);
-    grid.print_choices(std::cout);
-    grid.print_status(std::cout);
-    std::cout << std::endl;
+/**
+ * solves a sudoku and prints the steps. with apply_all every iteration
+ * applies all hints of one producer pass, otherwise only the first one.
+ */
+bool solve(const std::string &s, SudokuSolver &solver, bool apply_all,
+        std::ostream &out) {
+    Grid grid;
+
+    if (!grid.load(s.data(), s.data() + s.size())) {
+        out << "invalid sudoku" << std::endl;
+        return false;
+    }
+    grid.print(out);
+    grid.print_choices(out);
+    grid.print_status(out);
+    out << std::endl;
 
     int iteration = 0;
     while (true) {
         ++iteration;
-        std::cout << "iteration: " << iteration << std::endl;
-        SingleHintConsumer consumer(grid);
-        for (std::vector<HintProducer *>::const_iterator i =
-                hintproducers.begin(); i != hintproducers.end(); ++i) {
-            (*i)->find_hints(grid, consumer);
-            if (consumer.has_hints())
+        out << "iteration: " << iteration << std::endl;
+        if (apply_all) {
+            BatchHintConsumer consumer(grid, out);
+            if (!solver.find_hints(grid, consumer))
                 break;
+            consumer.apply_hints();
+        } else {
+            Hint *hint = solver.find_next_hint(grid);
+            if (!hint)
+                break;
+            SingleHintConsumer consumer(grid, out);
+            consumer.consume_hint(hint);
         }
-        if (!consumer.has_hints())
+        grid.print_choices(out);
+        grid.print_status(out);
+        out << std::endl;
+    }
+    out << "result: " << std::endl;
+    grid.print_choices(out);
+    grid.print_status(out);
+    out << std::endl;
+
+    return grid.get_to_do() == 0;
+}
+
+struct BatchJob {
+    int index;
+    std::string line;
+};
+
+struct BatchResult {
+    std::string line;
+    std::string output;
+    bool success;
+};
+
+struct WorkerStats {
+    int count;
+    double cpu_time;
+};
+
+void read_jobs(const PuzzleSource *source, BlockingQueue<BatchJob> *jobs) {
+    PuzzleReader reader(*source, 0, source->get_size());
+    const char *line;
+    const char *line_end;
+    BatchJob job;
+    job.index = 0;
+    while (reader.next(line, line_end)) {
+        job.line.assign(line, line_end);
+        if (!jobs->push(job))
             break;
-        grid.print_choices(std::cout);
-        grid.print_status(std::cout);
-        std::cout << std::endl;
+        ++job.index;
     }
-    std::cout << "result: " << std::endl;
-    grid.print_choices(std::cout);
-    grid.print_status(std::cout);
-    std::cout << std::endl;
+    jobs->close();
+}
 
-    std::for_each(hintproducers.begin(), hintproducers.end(), destroy<
-            HintProducer *> ());
+void solve_jobs(BlockingQueue<BatchJob> *jobs,
+        ReorderBuffer<BatchResult> *results, WorkerStats *stats,
+        SudokuSolver::Schedule schedule, bool apply_all) {
+    std::vector<HintProducer *> hintproducers;
+    create_hint_producers(hintproducers);
+    SudokuSolver solver(hintproducers);
+    solver.set_schedule(schedule);
+    /*
+     * a complete pass of the forcing chains costs more than the rescans
+     * it saves.
+     */
+    solver.set_exhaustive_producers(hintproducers.size() - 1);
 
-    return grid.get_to_do() == 0;
+    double start = thread_cpu_time();
+    BatchJob job;
+    while (jobs->pop(job)) {
+        std::ostringstream out;
+        BatchResult result;
+        out << job.index + 1 << ": " << job.line << std::endl;
+        result.success = solve(job.line, solver, apply_all, out);
+        result.line = job.line;
+        result.output = out.str();
+        results->put(job.index, result);
+        ++stats->count;
+    }
+    stats->cpu_time = thread_cpu_time() - start;
+
+    results->finish();
+}
+
+/**
+ * solves the puzzles on num_threads worker threads. a reader thread fills a
+ * bounded queue, the results are printed in input order.
+ */
+int solve_batch(const PuzzleSource &source, int num_threads,
+        SudokuSolver::Schedule schedule, bool apply_all) {
+    std::vector<std::pair<int, std::string> > failed;
+    BlockingQueue<BatchJob> jobs(4 * num_threads);
+    ReorderBuffer<BatchResult> results(num_threads, 4 * num_threads);
+    std::vector<WorkerStats> stats(num_threads);
+    std::vector<std::thread> threads;
+
+    std::chrono::steady_clock::time_point t1 =
+            std::chrono::steady_clock::now();
+
+    threads.push_back(std::thread(read_jobs, &source, &jobs));
+    for (int i = 0; i < num_threads; ++i) {
+        stats[i].count = 0;
+        stats[i].cpu_time = 0;
+        threads.push_back(std::thread(solve_jobs, &jobs, &results, &stats[i],
+                schedule, apply_all));
+    }
+
+    int i = 0;
+    int success_count = 0;
+    int failure_count = 0;
+    BatchResult result;
+    while (results.take(result)) {
+        ++i;
+        std::cout << result.output;
+        if (result.success)
+            ++success_count;
+        else {
+            ++failure_count;
+            failed.push_back(std::pair<int, std::string>(i, result.line));
+        }
+    }
+
+    for (std::vector<std::thread>::iterator t = threads.begin(); t
+            != threads.end(); ++t) {
+        t->join();
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - t1;
+    double cpu = 0;
+    for (int j = 0; j < num_threads; ++j)
+        cpu += stats[j].cpu_time;
+
+    std::cout << i << " sudokus success: " << success_count << " failures: "
+            << failure_count << " time: " << wall.count() << " seconds"
+            << std::endl;
+    std::cout << "threads: " << num_threads << " wall time: " << wall.count()
+            << " seconds cpu time: " << cpu << " seconds" << std::endl;
+    for (int j = 0; j < num_threads; ++j) {
+        std::cout << "thread " << j + 1 << ": " << stats[j].count
+                << " sudokus cpu time: " << stats[j].cpu_time << " seconds"
+                << std::endl;
+    }
+    if(!failed.empty()) {
+        std::cout << std::endl << "failed sudokus:" << std::endl << std::endl;
+    }
+    for(std::vector<std::pair<int, std::string> >::const_iterator f = failed.begin(); f != failed.end(); ++f) {
+        std::cout << f->first << ": " << f->second << std::endl;
+    }
+    return 0;
+}
+
+void usage() {
+    std::cerr << "usage: sudoku [--threads N] [--adaptive] [--apply-all] [file]" << std::endl;
 }
 
 int main(int argc, char *argv[]) {
     std::string filename = "../data/top95.txt";
     std::vector<std::pair<int, std::string> > failed;
+    int num_threads = 0;
+    SudokuSolver::Schedule schedule = SudokuSolver::SCHEDULE_HUMAN;
+    bool apply_all = false;
 
-    if (argc > 1) {
-        filename = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--adaptive") {
+            schedule = SudokuSolver::SCHEDULE_ADAPTIVE;
+        } else if (arg == "--apply-all") {
+            apply_all = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            if (num_threads < 1) {
+                usage();
+                exit(1);
+            }
+        } else {
+            filename = arg;
+        }
     }
 
-    std::ifstream in(filename.c_str());
-    if (!in) {
+    PuzzleSource source;
+    if (!source.open(filename)) {
         std::cerr << "cannot open file " << filename << std::endl;
         exit(1);
     }
 
+    if (num_threads > 0)
+        return solve_batch(source, num_threads, schedule, apply_all);
+
+    std::vector<HintProducer *> hintproducers;
+    create_hint_producers(hintproducers);
+    SudokuSolver solver(hintproducers);
+    solver.set_schedule(schedule);
+    /*
+     * a complete pass of the forcing chains costs more than the rescans
+     * it saves.
+     */
+    solver.set_exhaustive_producers(hintproducers.size() - 1);
+
     clock_t t1 = clock();
 
+    PuzzleReader reader(source, 0, source.get_size());
+    const char *begin;
+    const char *end;
     std::string line;
     int i = 0;
     int success_count = 0;
     int failure_count = 0;
-    while (getline(in, line)) {
+    while (reader.next(begin, end)) {
+        line.assign(begin, end);
         ++i;
 
         std::cout << i << ": " << line << std::endl;
-        if (solve(line))
+        if (solve(line, solver, apply_all, std::cout))
             ++success_count;
         else {
             ++failure_count;
@@ -145,6 +324,8 @@ int main(int argc, char *argv[]) {
     t /= CLOCKS_PER_SEC;
     std::cout << i << " sudokus success: " << success_count << " failures: "
             << failure_count << " time: " << t << " seconds" << std::endl;
+    if (schedule == SudokuSolver::SCHEDULE_ADAPTIVE || apply_all)
+        solver.print_statistics(std::cout);
     if(!failed.empty()) {
         std::cout << std::endl << "failed sudokus:" << std::endl << std::endl;
     }
@@ -50,6 +50,7 @@
 #include "swordfish.hpp"
 #include "range.hpp"
 #include "gridchecker.hpp"
+#include "solutioncache.hpp"
 
 class MyHintConsumer: public HintConsumer {
     bool success;
@@ -71,7 +72,7 @@ public:
 };
 
 SudokuGenerator::SudokuGenerator() :
-    difficulty(SudokuGenerator::MEDIUM), min_idx(2), max_idx(5) {
+    difficulty(SudokuGenerator::MEDIUM), min_idx(2), max_idx(5), cache(0) {
     hint_producers.push_back(new NakedSingleHintProducer());
     hint_producers.push_back(new SingleHintProducer());
     hint_producers.push_back(new NakedDoubleHintProducer());
@@ -107,6 +108,10 @@ void SudokuGenerator::set_difficulty(SudokuGenerator::Difficulty difficulty) {
     }
 }
 
+void SudokuGenerator::set_cache(SolutionCache *cache) {
+    this->cache = cache;
+}
+
 void SudokuGenerator::generate(Grid &grid) {
     std::srand(static_cast<unsigned int>(std::time(0)));
     do {
@@ -114,14 +119,52 @@ void SudokuGenerator::generate(Grid &grid) {
     } while (!check_difficulty(grid));
 }
 
+/*
+ * the rating of a grid is looked up in the cache first. a rating which has
+ * been cut short by a lower max_idx is only a lower bound.
+ */
 bool SudokuGenerator::check_difficulty(const Grid &testgrid) {
+    std::string key;
+    if (cache && testgrid.has_all_choices()) {
+        unsigned char canonical[81];
+        Transformation transformation;
+        canonicalizer.canonicalize(testgrid, canonical, transformation);
+        key = SolutionCache::make_key(canonical);
+
+        CacheEntry entry;
+        if (cache->lookup(key, entry) && entry.rating != CacheEntry::UNKNOWN) {
+            if (entry.rating_exact)
+                return entry.rating >= min_idx && entry.rating <= max_idx;
+            if (entry.rating > max_idx)
+                return false;
+        }
+    }
+
+    bool exact;
+    int rating = rate(testgrid, exact);
+    if (!key.empty()) {
+        CacheEntry entry;
+        entry.rating = rating;
+        entry.rating_exact = exact;
+        cache->store(key, entry);
+    }
+    return exact && rating >= min_idx && rating <= max_idx;
+}
+
+/**
+ * returns the index of the hardest hint producer needed to solve the grid
+ * or CacheEntry::TOO_HARD. as soon as a step needs a producer beyond
+ * max_idx the search stops and a lower bound is returned.
+ */
+int SudokuGenerator::rate(const Grid &testgrid, bool &exact) const {
     Grid grid = testgrid;
     int max_found_idx = 0;
+    exact = true;
     while (grid.get_to_do() > 0) {
         bool success = false;
         int found_idx = 0;
-        for (std::vector<HintProducer *>::iterator i = hint_producers.begin(); i
-                != hint_producers.end(); ++i) {
+        for (std::vector<HintProducer *>::const_iterator i =
+                hint_producers.begin(); i != hint_producers.end(); ++i) {
             MyHintConsumer consumer(grid);
             (*i)->find_hints(grid, consumer);
             if (!consumer.wants_more_hints()) {
@@ -132,12 +175,17 @@ bool SudokuGenerator::check_difficulty(const Grid &testgrid) {
             if (found_idx > max_idx)
                 break;
         }
-        if (!success)
-            return false;
+        if (!success) {
+            if (found_idx < static_cast<int> (hint_producers.size())) {
+                exact = false;
+                return found_idx;
+            }
+            return CacheEntry::TOO_HARD;
+        }
         if (found_idx > max_found_idx)
             max_found_idx = found_idx;
     }
-    return max_found_idx >= min_idx && max_found_idx <= max_idx;
+    return max_found_idx;
 }
 
 void SudokuGenerator::do_generate(Grid &grid) {
@@ -145,8 +193,8 @@ void SudokuGenerator::do_generate(Grid &grid) {
     generate_full(0);
     for (Grid::iterator i = grid.begin(); i != grid.end(); ++i) {
         Cell &cell = *i;
-        cell.set_value(field[cell.get_idx()]);
-        cell.clear_choices();
+        grid.set_cell_value(cell, field[cell.get_idx()]);
+        grid.clear_choices(cell);
     }
     remove_fields(grid);
 }
@@ -182,23 +230,18 @@ int SudokuGenerator::random_choice(Choices &choices) const {
     int num_choices = choices.get_num_choices();
     if (num_choices == 0)
         return 0;
-    int idx = rand() % choices.get_num_choices() + 1;
-    int i = 0;
-
-    for (int value = 1; value <= 9; ++value) {
-        if (choices.has_choice(value)) {
-            ++i;
-            if (i == idx) {
-                return value;
-            }
-        }
-    }
+    int idx = rand() % num_choices;
+    int value = choices.first_choice();
+
+    for (int i = 0; i < idx; ++i)
+        value = choices.next_choice(value);
 
-    return 0;
+    return value;
 }
 
 void SudokuGenerator::remove_fields(Grid &grid) const {
     GridChecker checker;
+    checker.set_cache(cache);
     const int min_filled_cells = 20;
     Grid backup = grid;
     bool used[81];
@@ -221,7 +264,7 @@ void SudokuGenerator::remove_fields(Grid &grid) const {
         grid.clear_cell_value(grid[idx]);
         if (!checker.check(grid)) {
             Cell &cell = grid[idx];
-            cell.set_value(backup[idx].get_value());
+            grid.set_cell_value(cell, backup[idx].get_value());
             grid.cleanup_choice(cell);
         } else {
             --filled_count;
@@ -35,9 +35,12 @@
 
 #include <vector>
 
+#include "canonicalform.hpp"
+
 class Grid;
 class Choices;
 class HintProducer;
+class SolutionCache;
 
 class SudokuGenerator {
 public:
@@ -48,12 +51,16 @@ private:
     Difficulty difficulty;
     int min_idx;
     int max_idx;
+    SolutionCache *cache;
+    Canonicalizer canonicalizer;
 public:
     SudokuGenerator();
     ~SudokuGenerator();
     void generate(Grid &grid);
     Difficulty get_difficulty() const;
     void set_difficulty(Difficulty difficulty);
+    /*! \brief sets the cache for uniqueness checks and ratings or 0, the cache is not owned */
+    void set_cache(SolutionCache *cache);
 private:
     SudokuGenerator(const SudokuGenerator &other) {
     }
@@ -66,6 +73,7 @@ private:
     int random_choice(Choices &choices) const;
     void remove_fields(Grid &grid) const;
     bool check_difficulty(const Grid &grid);
+    int rate(const Grid &grid, bool &exact) const;
 };
 
 #endif
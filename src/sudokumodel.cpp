@@ -85,6 +85,7 @@ void SudokuModel::generate() {
     else if (difficulty_level == HARD)
         d = SudokuGenerator::HARD;
     generator.set_difficulty(d);
+    generator.set_cache(&cache);
     generator.generate(grid);
     undo_manager.clear();
     m_signal_changed.emit();
@@ -134,7 +135,8 @@ SudokuModel::SudokuModel() :
         highlighted_choice(0),
         difficulty_level(SudokuModel::EASY), 
         show_choices(true), 
-        current_hint(0) {
+        current_hint(0),
+        cache(1 << 16) {
 }
 
 int SudokuModel::get_selected_cell() const {
@@ -179,7 +181,7 @@ void SudokuModel::set_current_cell_value(int value) {
         grid.clear_cell_value(grid[selected_cell]);
     SetValueCommand *command = new SetValueCommand(grid, value, selected_cell);
     undo_manager.add_undo_command(command);
-    cell.set_value(value);
+    grid.set_cell_value(cell, value);
     grid.cleanup_choice(cell);
     m_signal_changed.emit();
     m_signal_changed.emit();
@@ -193,12 +195,12 @@ void SudokuModel::toggle_current_cell_choice(int value) {
         RemoveChoiceCommand *command = new RemoveChoiceCommand(grid, value,
                 selected_cell);
         undo_manager.add_undo_command(command);
-        cell.remove_choice(value);
+        grid.remove_choice(cell, value);
     } else {
         AddChoiceCommand *command = new AddChoiceCommand(grid, value,
                 selected_cell);
         undo_manager.add_undo_command(command);
-        cell.add_choice(value);
+        grid.add_choice(cell, value);
     }
     clear_current_hint();
     m_signal_changed.emit();
@@ -283,6 +285,7 @@ void SudokuModel::print(std::ostream &out) const {
 
 bool SudokuModel::check() const {
     GridChecker checker;
+    checker.set_cache(&cache);
     return checker.check(grid);
 }
 
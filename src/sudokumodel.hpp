@@ -36,6 +36,7 @@
 #include "gtkmm.h"
 #include <string>
 #include "grid.hpp"
+#include "solutioncache.hpp"
 
 #include "commands.hpp"
 
@@ -58,6 +59,12 @@ private:
     DifficultyLevel difficulty_level;
     bool show_choices;
     Hint *current_hint;
+    /*
+     * the uniqueness checks and ratings of the generator and of check(),
+     * shared by all puzzles of a session. check() is const, the cache is
+     * not part of the state of the model.
+     */
+    mutable SolutionCache cache;
 public:
     /**
      * constructor
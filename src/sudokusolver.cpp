@@ -31,6 +31,8 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 
 #include "sudokusolver.hpp"
 #include "util.hpp"
@@ -51,7 +53,8 @@
 #include "xywing.hpp"
 #include "nakedsingle.hpp"
 
-SudokuSolver::SudokuSolver() {
+SudokuSolver::SudokuSolver() :
+    schedule(SCHEDULE_HUMAN) {
     hintproducers.push_back(new NakedSingleHintProducer());
     hintproducers.push_back(new SingleHintProducer());
     hintproducers.push_back(new NakedDoubleHintProducer());
@@ -64,11 +67,14 @@ SudokuSolver::SudokuSolver() {
     hintproducers.push_back(new XYWingHintProducer());
     hintproducers.push_back(new SwordfishHintProducer());
     hintproducers.push_back(new ForcingChainHintProducer());
+    exhaustive_producers = hintproducers.size();
+    init_stats();
 }
 
 SudokuSolver::SudokuSolver(std::vector<HintProducer *> hintproducers)
-   : hintproducers(hintproducers) {
-
+   : hintproducers(hintproducers), schedule(SCHEDULE_HUMAN),
+     exhaustive_producers(hintproducers.size()) {
+    init_stats();
 }
 
 SudokuSolver::~SudokuSolver() {
@@ -76,15 +82,31 @@ SudokuSolver::~SudokuSolver() {
             HintProducer *> ());
 }
 
+void SudokuSolver::init_stats() {
+    ProducerStats empty = { 0, 0, 0.0, false, 0, 0 };
+    stats.assign(hintproducers.size(), empty);
+}
+
+SudokuSolver::Schedule SudokuSolver::get_schedule() const {
+    return schedule;
+}
+
+void SudokuSolver::set_schedule(Schedule schedule) {
+    this->schedule = schedule;
+}
+
+int SudokuSolver::get_exhaustive_producers() const {
+    return exhaustive_producers;
+}
+
+void SudokuSolver::set_exhaustive_producers(int count) {
+    exhaustive_producers = count;
+}
+
 void SudokuSolver::solve(Grid &grid, HintConsumer &consumer) {
-    while (true) {
-        for (std::vector<HintProducer *>::const_iterator i =
-                hintproducers.begin(); i != hintproducers.end(); ++i) {
-            (*i)->find_hints(grid, consumer);
-            if (!consumer.wants_more_hints())
-                break;
-        }
-        if (!consumer.wants_more_hints())
+    while (consumer.wants_more_hints()) {
+        Hint *hint = find_next_hint(grid);
+        if (!hint || !consumer.consume_hint(hint))
             break;
     }
 }
@@ -116,15 +138,124 @@ Hint *FindNextHintConsumer::get_hint() {
     return hint;
 }
 
-Hint *SudokuSolver::find_next_hint(Grid &grid) {
-    FindNextHintConsumer consumer;
+/*
+ * a producer which found nothing stays idle until the grid changes.
+ */
+bool SudokuSolver::is_idle(int producer, const Grid &grid) const {
+    const ProducerStats &s = stats[producer];
+    return s.idle && s.idle_serial == grid.get_serial() && s.idle_epoch
+            == grid.get_epoch();
+}
 
-    for (std::vector<HintProducer *>::const_iterator i = hintproducers.begin(); i
-            != hintproducers.end(); ++i) {
-        (*i)->find_hints(grid, consumer);
-        if (!consumer.wants_more_hints())
-            break;
+/*
+ * counts the hints passed on to an other consumer and stops the producer
+ * after the first hint, if the pass is not exhaustive.
+ */
+class CountingHintConsumer: public HintConsumer {
+private:
+    HintConsumer &consumer;
+    int count;
+    bool exhaustive;
+public:
+    CountingHintConsumer(HintConsumer &consumer, bool exhaustive) :
+        consumer(consumer), count(0), exhaustive(exhaustive) {
+    }
+
+    bool consume_hint(Hint *hint) {
+        ++count;
+        return consumer.consume_hint(hint) && exhaustive;
+    }
+
+    bool wants_more_hints() const {
+        return consumer.wants_more_hints() && (exhaustive || count == 0);
     }
 
+    int get_count() const {
+        return count;
+    }
+};
+
+bool SudokuSolver::run_producer(int producer, Grid &grid,
+        HintConsumer &consumer) {
+    CountingHintConsumer counter(consumer, producer < exhaustive_producers);
+    ProducerStats &s = stats[producer];
+
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    hintproducers[producer]->find_hints(grid, counter);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()
+            - start;
+
+    ++s.calls;
+    s.seconds += elapsed.count();
+    bool found = counter.get_count() > 0;
+    if (found) {
+        ++s.hits;
+        s.idle = false;
+    } else {
+        s.idle = true;
+        s.idle_serial = grid.get_serial();
+        s.idle_epoch = grid.get_epoch();
+    }
+    return found;
+}
+
+/**
+ * returns the producer to ask next or -1 if all are idle. the expected
+ * cost of a hint is the time per call divided by the hit rate.
+ */
+int SudokuSolver::choose_producer(const Grid &grid) const {
+    int best = -1;
+    double best_cost = 0;
+    int untried = -1;
+
+    for (int i = 0; i < static_cast<int> (hintproducers.size()); ++i) {
+        if (is_idle(i, grid))
+            continue;
+        const ProducerStats &s = stats[i];
+        if (s.calls == 0) {
+            if (untried < 0)
+                untried = i;
+            continue;
+        }
+        double cost = s.seconds / s.calls * (s.calls + 1) / (s.hits + 1);
+        if (best < 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    return best >= 0 ? best : untried;
+}
+
+bool SudokuSolver::find_hints(Grid &grid, HintConsumer &consumer) {
+    if (schedule == SCHEDULE_HUMAN) {
+        for (int i = 0; i < static_cast<int> (hintproducers.size()); ++i) {
+            if (is_idle(i, grid))
+                continue;
+            if (run_producer(i, grid, consumer))
+                return true;
+        }
+        return false;
+    }
+
+    int producer;
+    while ((producer = choose_producer(grid)) >= 0) {
+        if (run_producer(producer, grid, consumer))
+            return true;
+    }
+    return false;
+}
+
+Hint *SudokuSolver::find_next_hint(Grid &grid) {
+    FindNextHintConsumer consumer;
+    find_hints(grid, consumer);
     return consumer.get_hint();
 }
+
+void SudokuSolver::print_statistics(std::ostream &out) const {
+    for (size_t i = 0; i < hintproducers.size(); ++i) {
+        const ProducerStats &s = stats[i];
+        out << i << ": calls: " << s.calls << " hits: " << s.hits
+                << " time: " << s.seconds << " seconds" << std::endl;
+    }
+}
@@ -40,17 +40,73 @@ class Hint;
 class Grid;
 
 #include <vector>
+#include <iosfwd>
 
+/**
+ * Solves a grid with hint producers, which are ordered from the cheapest
+ * to the most expensive.
+ *
+ * With SCHEDULE_HUMAN the next hint is the one a human would find first:
+ * the producers are asked in their order. With SCHEDULE_ADAPTIVE the
+ * producer with the lowest measured cost per hint is asked first; producers
+ * which have not been run yet are only tried when all others are done, so
+ * the cheap rules are exhausted before escalating.
+ *
+ * In both schedules a producer which found no hint is not asked again
+ * until the grid has changed. Both schedules end with the same grid, only
+ * the order of the hints differs.
+ *
+ * find_hints passes all hints of one producer pass to the consumer, so a
+ * BatchHintConsumer can apply them together before the grid is rescanned.
+ * Expensive producers at the end of the list can be limited to their first
+ * hint with set_exhaustive_producers.
+ */
 class SudokuSolver {
+public:
+    enum Schedule {
+        SCHEDULE_HUMAN, SCHEDULE_ADAPTIVE
+    };
 private:
+    struct ProducerStats {
+        long calls;
+        long hits;
+        double seconds;
+        bool idle;
+        unsigned idle_serial;
+        unsigned idle_epoch;
+    };
     std::vector<HintProducer *> hintproducers;
+    std::vector<ProducerStats> stats;
+    Schedule schedule;
+    int exhaustive_producers;
 public:
     SudokuSolver();
     SudokuSolver(std::vector<HintProducer *> hintproducers);
     virtual ~SudokuSolver();
+    /*! \brief passes hints to the consumer until it wants no more or no hint is left */
     void solve(Grid &grid, HintConsumer &consumer);
+    /*!
+     * \brief feeds the hints of the first producer which finds any into
+     * the consumer.
+     * \returns false, if no producer found a hint
+     */
+    bool find_hints(Grid &grid, HintConsumer &consumer);
     Hint *find_next_hint(Grid &grid);
+    Schedule get_schedule() const;
+    void set_schedule(Schedule schedule);
+    int get_exhaustive_producers() const;
+    /*!
+     * \brief only the first count producers pass all of their hints to
+     * find_hints, the others stop after the first hint.
+     */
+    void set_exhaustive_producers(int count);
+    /*! \brief prints the calls, hits and time of each producer */
+    void print_statistics(std::ostream &out) const;
 private:
+    void init_stats();
+    bool is_idle(int producer, const Grid &grid) const;
+    bool run_producer(int producer, Grid &grid, HintConsumer &consumer);
+    int choose_producer(const Grid &grid) const;
     SudokuSolver(const SudokuSolver &other) {}
     SudokuSolver &operator =(const SudokuSolver &other) { return *this; }
 };
@@ -65,23 +65,23 @@ const char *SwordfishHint::get_name() const {
 
 void SwordfishHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
     for (int value = 1; value < 10; ++value) {
-        find_swordfishes(value, grid, RANGES.get_rows(), RANGES.get_columns(),
-                consumer);
+        find_swordfishes(value, grid, RANGES.get_rows(), 0,
+                RANGES.get_columns(), consumer);
         if (!consumer.wants_more_hints())
             return;
-        find_swordfishes(value, grid, RANGES.get_columns(), RANGES.get_rows(),
-                consumer);
+        find_swordfishes(value, grid, RANGES.get_columns(), 9,
+                RANGES.get_rows(), consumer);
         if (!consumer.wants_more_hints())
             return;
     }
 }
 
 void SwordfishHintProducer::find_swordfishes(int value, Grid &grid,
-        const std::vector<Range> &row_ranges,
-        const std::vector<Range> &col_ranges, HintConsumer &consumer) const {
+        const Range *row_ranges, int first_house,
+        const Range *col_ranges, HintConsumer &consumer) const {
     std::vector<std::bitset<9> > rowsets(9);
 
-    fill_rowsets(value, grid, row_ranges, rowsets);
+    fill_rowsets(value, grid, first_house, rowsets);
 
     for (int i = 0; i < 9; ++i) {
         if (rowsets[i].count() > 1) {
@@ -111,8 +111,8 @@ void SwordfishHintProducer::find_swordfishes(int value, Grid &grid,
 
 SwordfishHint *SwordfishHintProducer::create_swordfish_hint(int value,
         int row1, int row2, int row3, const std::bitset<9> &columnset,
-        const std::vector<Range> &ranges,
-        const std::vector<Range> &secondary_ranges, Grid &grid) const {
+        const Range *ranges,
+        const Range *secondary_ranges, Grid &grid) const {
     std::vector<int> cols;
     std::vector<int> cells_to_clear;
 
@@ -149,12 +149,10 @@ SwordfishHint *SwordfishHintProducer::create_swordfish_hint(int value,
 }
 
 void SwordfishHintProducer::fill_rowsets(int value, Grid &grid,
-        const std::vector<Range> &ranges, std::vector<std::bitset<9> > &bitsets) const {
+        int first_house, std::vector<std::bitset<9> > &bitsets) const {
     for (int i = 0; i < 9; ++i) {
-        const Range &range = ranges[i];
-        for (int j = 0; j < 9; ++j) {
-            bitsets[i][j] = grid[range[j]].has_choice(value);
-        }
+        bitsets[i] = std::bitset<9>(grid.get_house_positions(first_house + i,
+                value));
     }
 }
 
@@ -57,13 +57,13 @@ public:
     void find_hints(Grid &grid, HintConsumer &consumer);
 private:
     void find_swordfishes(int value, Grid &grid,
-            const std::vector<Range> &row_ranges,
-            const std::vector<Range> &col_ranges, HintConsumer &consumer) const;
+            const Range *row_ranges, int first_house,
+            const Range *col_ranges, HintConsumer &consumer) const;
     SwordfishHint *create_swordfish_hint(int value, int row1, int row2,
             int row3, const std::bitset<9> &columnset,
-            const std::vector<Range> &ranges,
-            const std::vector<Range> &secondary_ranges, Grid &grid) const;
-    void fill_rowsets(int value, Grid &grid, const std::vector<Range> &ranges,
+            const Range *ranges,
+            const Range *secondary_ranges, Grid &grid) const;
+    void fill_rowsets(int value, Grid &grid, int first_house,
             std::vector<std::bitset<9> > &bitsets) const;
     SwordfishHint *create_hint(Grid &grid,
             int value,
@@ -34,6 +34,7 @@
 #define UTIL_HPP_
 
 #include <iostream>
+#include <ctime>
 
 template<class T>
 struct destroy {
@@ -60,4 +61,17 @@ inline std::ostream &operator <<(std::ostream &out,
     return out;
 }
 
+/**
+ * returns the cpu time used by the calling thread in seconds. falls back
+ * to the cpu time of the process where there is no per thread clock.
+ */
+inline double thread_cpu_time() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+    return double(clock()) / CLOCKS_PER_SEC;
+}
+
 #endif
@@ -76,25 +76,11 @@ void XWingHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
 }
 
 int XWingHintProducer::count_col_value(Grid &grid, int col, int value) const {
-    const Range &range = RANGES.get_column(col);
-    int count = 0;
-    for (Range::const_iterator irange = range.begin(); irange != range.end(); ++irange) {
-        Cell &cell = grid[*irange];
-        if (cell.has_choice(value))
-            ++count;
-    }
-    return count;
+    return count_bits(grid.get_house_positions(9 + col, value));
 }
 
 int XWingHintProducer::count_row_value(Grid &grid, int row, int value) const {
-    const Range &range = RANGES.get_row(row);
-    int count = 0;
-    for (Range::const_iterator irange = range.begin(); irange != range.end(); ++irange) {
-        Cell &cell = grid[*irange];
-        if (cell.has_choice(value))
-            ++count;
-    }
-    return count;
+    return count_bits(grid.get_house_positions(row, value));
 }
 
 bool XWingHintProducer::check_second_row(int row, int col1, int col2,
@@ -140,10 +126,10 @@ void XWingHintProducer::fill_row_freq(Grid &grid, int row, std::vector<
     const Range &range = RANGES.get_row(row);
     for (Range::const_iterator irange = range.begin(); irange != range.end(); ++irange) {
         Cell &cell = grid[*irange];
-        for (int value = 1; value < 10; ++value) {
-            if (cell.has_choice(value)) {
-                freq[value].push_back(&cell);
-            }
+        const Choices &choices = cell.get_choices();
+        for (int value = choices.first_choice(); value != 0; value
+                = choices.next_choice(value)) {
+            freq[value].push_back(&cell);
         }
     }
 }
@@ -173,10 +159,10 @@ void XWingHintProducer::fill_col_freq(Grid &grid, int col, std::vector<
     const Range &range = RANGES.get_column(col);
     for (Range::const_iterator irange = range.begin(); irange != range.end(); ++irange) {
         Cell &cell = grid[*irange];
-        for (int value = 1; value < 10; ++value) {
-            if (cell.has_choice(value)) {
-                freq[value].push_back(&cell);
-            }
+        const Choices &choices = cell.get_choices();
+        for (int value = choices.first_choice(); value != 0; value
+                = choices.next_choice(value)) {
+            freq[value].push_back(&cell);
         }
     }
 }
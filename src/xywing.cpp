@@ -66,13 +66,9 @@ void XYWingHintProducer::find_hints(Grid &grid, HintConsumer &consumer) {
 }
 
 void XYWingHintProducer::fill_cell_values(const Cell &cell, int values[2]) const {
-    int idx = 0;
-    for (int value = 1; value < 10; ++value) {
-        if (cell.has_choice(value)) {
-            values[idx] = value;
-            ++idx;
-        }
-    }
+    const Choices &choices = cell.get_choices();
+    values[0] = choices.first_choice();
+    values[1] = choices.next_choice(values[0]);
 }
 
 void XYWingHintProducer::find_xy_wing(Cell &cell, Grid &grid,